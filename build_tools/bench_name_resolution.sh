@@ -0,0 +1,57 @@
+#!/usr/bin/env bash
+#
+# Benchmark name resolution in p4mlir-translate on a synthetic program with
+# lots of actions and locals referencing each other.
+#
+# Usage: bench_name_resolution.sh <p4mlir-translate> [<p4mlir-translate>...]
+#
+# Each binary given (e.g. built before and after a change) translates the same
+# program, so their times could be compared. The size of the program is
+# controlled by NUM_ACTIONS and NUM_LOCALS environment variables, the number of
+# runs per binary by NUM_RUNS. Additional options (e.g. "--roots a0" to convert
+# a single action) could be passed to p4mlir-translate via TRANSLATE_ARGS.
+
+set -e
+
+if [ $# -eq 0 ]; then
+    echo "Usage: $0 <p4mlir-translate> [<p4mlir-translate>...]" >&2
+    exit 1
+fi
+
+NUM_ACTIONS=${NUM_ACTIONS:-1000}
+NUM_LOCALS=${NUM_LOCALS:-50}
+NUM_RUNS=${NUM_RUNS:-3}
+TRANSLATE_ARGS=${TRANSLATE_ARGS:-}
+
+WORK_DIR=$(mktemp -d)
+trap 'rm -rf "$WORK_DIR"' EXIT
+PROGRAM=$WORK_DIR/bench.p4
+
+# Every action declares locals, each computed from the previous ones, and
+# calls the previous action, so every statement needs several lookups.
+{
+    for ((a = 0; a < NUM_ACTIONS; a++)); do
+        echo "action a$a(inout bit<32> arg) {"
+        echo "    bit<32> l0 = arg;"
+        for ((l = 1; l < NUM_LOCALS; l++)); do
+            echo "    bit<32> l$l = l$((l - 1)) + arg;"
+        done
+        if [ $a -gt 0 ]; then
+            echo "    a$((a - 1))(l$((NUM_LOCALS - 1)));"
+        fi
+        echo "    arg = l$((NUM_LOCALS - 1));"
+        echo "}"
+    done
+} > "$PROGRAM"
+
+echo "Program: $NUM_ACTIONS actions, $NUM_LOCALS locals each, $(wc -l < "$PROGRAM") lines"
+
+for TRANSLATE in "$@"; do
+    for ((r = 0; r < NUM_RUNS; r++)); do
+        START=$(date +%s.%N)
+        # shellcheck disable=SC2086
+        "$TRANSLATE" --typeinference-only $TRANSLATE_ARGS "$PROGRAM" > /dev/null
+        END=$(date +%s.%N)
+        echo "$TRANSLATE: run $r: $(awk "BEGIN { print $END - $START }") s"
+    done
+done
@@ -0,0 +1,69 @@
+#ifndef P4MLIR_DIALECT_P4HIR_P4HIR_LAZYLOADING_H
+#define P4MLIR_DIALECT_P4HIR_P4HIR_LAZYLOADING_H
+
+#include <memory>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MemoryBufferRef.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "p4mlir/Dialect/P4HIR/P4HIR_Ops.h"
+
+namespace mlir {
+class BytecodeReader;
+}  // namespace mlir
+
+namespace P4::P4MLIR::P4HIR {
+
+/// P4HIR module read from MLIR bytecode with bodies of `p4hir.func`
+/// operations loaded on demand. Everything else (symbols, function signatures
+/// and argument attributes) is available right after opening.
+///
+/// Until materialized, a function has an empty body and therefore looks like
+/// a declaration. Only passes that do not reason about other functions'
+/// bodies (e.g. canonicalization or per-function analyses) should be run
+/// before the whole module is materialized.
+class LazyModule {
+ public:
+    /// Reads the top-level structure of the module from bytecode `buffer`,
+    /// which must outlive the returned object. Returns nullptr and emits a
+    /// diagnostic on error.
+    static std::unique_ptr<LazyModule> open(llvm::MemoryBufferRef buffer,
+                                            mlir::MLIRContext *context);
+
+    ~LazyModule();
+
+    mlir::ModuleOp getModule() { return *module; }
+
+    /// Returns whether body of the given function is loaded.
+    bool isMaterialized(FuncOp func);
+
+    /// Loads and verifies body of the given function. No-op if already loaded.
+    mlir::LogicalResult materialize(FuncOp func);
+
+    /// Loads body of the top-level function with the given name.
+    mlir::LogicalResult materialize(llvm::StringRef name);
+
+    /// Loads all the function bodies that are not yet loaded. The module is
+    /// complete afterwards and no further loading is possible.
+    mlir::LogicalResult materializeAll();
+
+    /// Number of functions whose bodies are not loaded yet.
+    int64_t getNumUnmaterialized() const;
+
+    /// Releases the module. Function bodies that are not loaded yet are lost,
+    /// so materializeAll() should be called first if the full module is
+    /// needed.
+    mlir::OwningOpRef<mlir::ModuleOp> release() { return std::move(module); }
+
+ private:
+    LazyModule(std::unique_ptr<mlir::BytecodeReader> reader,
+               mlir::OwningOpRef<mlir::ModuleOp> module);
+
+    std::unique_ptr<mlir::BytecodeReader> reader;
+    mlir::OwningOpRef<mlir::ModuleOp> module;
+};
+
+}  // namespace P4::P4MLIR::P4HIR
+
+#endif  // P4MLIR_DIALECT_P4HIR_P4HIR_LAZYLOADING_H
@@ -0,0 +1,25 @@
+#ifndef P4MLIR_TRANSFORMS_PASSES_H
+#define P4MLIR_TRANSFORMS_PASSES_H
+
+#include <memory>
+
+#include "mlir/Pass/Pass.h"
+
+namespace P4::P4MLIR {
+
+#define GEN_PASS_DECL
+#include "p4mlir/Transforms/Passes.h.inc"
+
+std::unique_ptr<mlir::Pass> createSCCPPass();
+std::unique_ptr<mlir::Pass> createCallEffectsPass();
+std::unique_ptr<mlir::Pass> createMem2RegPass();
+std::unique_ptr<mlir::Pass> createIntRangeOptimizationsPass();
+std::unique_ptr<mlir::Pass> createNarrowBitWidthPass();
+std::unique_ptr<mlir::Pass> createEliminateInfIntPass();
+
+#define GEN_PASS_REGISTRATION
+#include "p4mlir/Transforms/Passes.h.inc"
+
+}  // namespace P4::P4MLIR
+
+#endif  // P4MLIR_TRANSFORMS_PASSES_H
@@ -0,0 +1,224 @@
+#include "llvm/ADT/TypeSwitch.h"
+#include "mlir/Bytecode/BytecodeImplementation.h"
+#include "p4mlir/Dialect/P4HIR/P4HIR_Attrs.h"
+#include "p4mlir/Dialect/P4HIR/P4HIR_Dialect.h"
+#include "p4mlir/Dialect/P4HIR/P4HIR_Types.h"
+
+using namespace mlir;
+using namespace P4::P4MLIR;
+
+namespace {
+
+// Codes of the types and attributes having compact bytecode encoding. These
+// are part of the bytecode format: new codes should only be appended, existing
+// ones should never be changed or reused.
+namespace TypeCode {
+enum : uint64_t {
+    Bits = 0,
+    Bool = 1,
+    InfInt = 2,
+    Void = 3,
+    Dontcare = 4,
+    Error = 5,
+    Unknown = 6,
+    Reference = 7,
+    Func = 8,
+};
+}  // namespace TypeCode
+
+namespace AttrCode {
+enum : uint64_t {
+    Int = 0,
+    Bool = 1,
+    ParamDirection = 2,
+};
+}  // namespace AttrCode
+
+// Version of P4HIR bytecode encoding. Should be bumped whenever the encoding of
+// existing types, attributes or operations changes in incompatible way.
+constexpr uint64_t kBytecodeVersion = 0;
+
+struct P4HIRDialectVersion : public DialectVersion {
+    explicit P4HIRDialectVersion(uint64_t version) : version(version) {}
+    uint64_t version;
+};
+
+// Types and attributes without compact encoding (failure is returned from
+// write* methods) are emitted by the bytecode writer in their textual form.
+struct P4HIRBytecodeInterface : public BytecodeDialectInterface {
+    using BytecodeDialectInterface::BytecodeDialectInterface;
+
+    Type readType(DialectBytecodeReader &reader) const final {
+        auto *context = getContext();
+
+        uint64_t code;
+        if (failed(reader.readVarInt(code))) return {};
+
+        switch (code) {
+            case TypeCode::Bits: {
+                // Width and signedness are packed into a single varint
+                uint64_t widthAndSign;
+                if (failed(reader.readVarInt(widthAndSign))) return {};
+                return P4HIR::BitsType::get(context, widthAndSign >> 1, widthAndSign & 1);
+            }
+            case TypeCode::Bool:
+                return P4HIR::BoolType::get(context);
+            case TypeCode::InfInt:
+                return P4HIR::InfIntType::get(context);
+            case TypeCode::Void:
+                return P4HIR::VoidType::get(context);
+            case TypeCode::Dontcare:
+                return P4HIR::DontcareType::get(context);
+            case TypeCode::Error:
+                return P4HIR::ErrorType::get(context);
+            case TypeCode::Unknown:
+                return P4HIR::UnknownType::get(context);
+            case TypeCode::Reference: {
+                Type objectType;
+                if (failed(reader.readType(objectType))) return {};
+                return P4HIR::ReferenceType::get(context, objectType);
+            }
+            case TypeCode::Func: {
+                uint64_t hasReturnType;
+                Type returnType;
+                SmallVector<Type> inputs;
+                if (failed(reader.readVarInt(hasReturnType)) ||
+                    (hasReturnType && failed(reader.readType(returnType))) ||
+                    failed(reader.readTypes(inputs)))
+                    return {};
+                return P4HIR::FuncType::get(context, inputs, returnType);
+            }
+            default:
+                reader.emitError() << "unknown P4HIR type code: " << code;
+                return {};
+        }
+    }
+
+    LogicalResult writeType(Type type, DialectBytecodeWriter &writer) const final {
+        auto writeCode = [&](uint64_t code) {
+            writer.writeVarInt(code);
+            return success();
+        };
+
+        return llvm::TypeSwitch<Type, LogicalResult>(type)
+            .Case<P4HIR::BitsType>([&](P4HIR::BitsType bitsType) {
+                writer.writeVarInt(TypeCode::Bits);
+                writer.writeVarInt((uint64_t(bitsType.getWidth()) << 1) | bitsType.isSigned());
+                return success();
+            })
+            .Case<P4HIR::BoolType>([&](auto) { return writeCode(TypeCode::Bool); })
+            .Case<P4HIR::InfIntType>([&](auto) { return writeCode(TypeCode::InfInt); })
+            .Case<P4HIR::VoidType>([&](auto) { return writeCode(TypeCode::Void); })
+            .Case<P4HIR::DontcareType>([&](auto) { return writeCode(TypeCode::Dontcare); })
+            .Case<P4HIR::ErrorType>([&](auto) { return writeCode(TypeCode::Error); })
+            .Case<P4HIR::UnknownType>([&](auto) { return writeCode(TypeCode::Unknown); })
+            .Case<P4HIR::ReferenceType>([&](P4HIR::ReferenceType refType) {
+                writer.writeVarInt(TypeCode::Reference);
+                writer.writeType(refType.getObjectType());
+                return success();
+            })
+            .Case<P4HIR::FuncType>([&](P4HIR::FuncType funcType) {
+                writer.writeVarInt(TypeCode::Func);
+                auto returnType = funcType.getOptionalReturnType();
+                writer.writeVarInt(returnType != nullptr);
+                if (returnType) writer.writeType(returnType);
+                writer.writeTypes(funcType.getInputs());
+                return success();
+            })
+            .Default([](Type) { return failure(); });
+    }
+
+    Attribute readAttribute(DialectBytecodeReader &reader) const final {
+        auto *context = getContext();
+
+        uint64_t code;
+        if (failed(reader.readVarInt(code))) return {};
+
+        switch (code) {
+            case AttrCode::Int: {
+                // The width of the value is implied by fixed-width integer
+                // types and is stored explicitly otherwise
+                Type type;
+                if (failed(reader.readType(type))) return {};
+                uint64_t width;
+                if (auto bitsType = mlir::dyn_cast<P4HIR::BitsType>(type))
+                    width = bitsType.getWidth();
+                else if (failed(reader.readVarInt(width)))
+                    return {};
+                FailureOr<APInt> value = reader.readAPIntWithKnownWidth(width);
+                if (failed(value)) return {};
+                return P4HIR::IntAttr::getChecked([&] { return reader.emitError(); }, context,
+                                                  type, *value);
+            }
+            case AttrCode::Bool: {
+                uint64_t value;
+                if (failed(reader.readVarInt(value))) return {};
+                return P4HIR::BoolAttr::get(context, P4HIR::BoolType::get(context), value != 0);
+            }
+            case AttrCode::ParamDirection: {
+                uint64_t value;
+                if (failed(reader.readVarInt(value))) return {};
+                auto dir = P4HIR::symbolizeParamDirection(value);
+                if (!dir) {
+                    reader.emitError() << "invalid P4HIR parameter direction: " << value;
+                    return {};
+                }
+                return P4HIR::ParamDirectionAttr::get(context, *dir);
+            }
+            default:
+                reader.emitError() << "unknown P4HIR attribute code: " << code;
+                return {};
+        }
+    }
+
+    LogicalResult writeAttribute(Attribute attr, DialectBytecodeWriter &writer) const final {
+        return llvm::TypeSwitch<Attribute, LogicalResult>(attr)
+            .Case<P4HIR::IntAttr>([&](P4HIR::IntAttr intAttr) {
+                writer.writeVarInt(AttrCode::Int);
+                writer.writeType(intAttr.getType());
+                const APInt &value = intAttr.getValue();
+                if (!mlir::isa<P4HIR::BitsType>(intAttr.getType()))
+                    writer.writeVarInt(value.getBitWidth());
+                writer.writeAPIntWithKnownWidth(value);
+                return success();
+            })
+            .Case<P4HIR::BoolAttr>([&](P4HIR::BoolAttr boolAttr) {
+                writer.writeVarInt(AttrCode::Bool);
+                writer.writeVarInt(boolAttr.getValue());
+                return success();
+            })
+            .Case<P4HIR::ParamDirectionAttr>([&](P4HIR::ParamDirectionAttr dirAttr) {
+                writer.writeVarInt(AttrCode::ParamDirection);
+                writer.writeVarInt(static_cast<uint64_t>(dirAttr.getValue()));
+                return success();
+            })
+            .Default([](Attribute) { return failure(); });
+    }
+
+    void writeVersion(DialectBytecodeWriter &writer) const final {
+        writer.writeVarInt(kBytecodeVersion);
+    }
+
+    std::unique_ptr<DialectVersion> readVersion(DialectBytecodeReader &reader) const final {
+        uint64_t version;
+        if (failed(reader.readVarInt(version))) return nullptr;
+        if (version > kBytecodeVersion) {
+            reader.emitError() << "P4HIR bytecode version " << version
+                               << " is newer than the supported one (" << kBytecodeVersion
+                               << ")";
+            return nullptr;
+        }
+        return std::make_unique<P4HIRDialectVersion>(version);
+    }
+
+    LogicalResult upgradeFromVersion(Operation *, const DialectVersion &) const final {
+        // Nothing to upgrade: there is only a single version so far
+        return success();
+    }
+};
+
+}  // namespace
+
+void P4HIR::P4HIRDialect::registerBytecodeInterface() {
+    addInterfaces<P4HIRBytecodeInterface>();
+}
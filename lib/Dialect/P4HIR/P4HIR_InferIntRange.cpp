@@ -0,0 +1,206 @@
+#include "p4mlir/Dialect/P4HIR/P4HIR_Ops.h"
+
+#include "mlir/Interfaces/InferIntRangeInterface.h"
+#include "mlir/Interfaces/Utils/InferIntRangeCommon.h"
+#include "p4mlir/Dialect/P4HIR/P4HIR_Attrs.h"
+#include "p4mlir/Dialect/P4HIR/P4HIR_Types.h"
+
+using namespace mlir;
+using namespace mlir::intrange;
+using namespace P4::P4MLIR;
+
+// Ranges are tracked for fixed-width integers and for booleans (as 1-bit
+// values). Returns 0 for all other types.
+static unsigned getRangeWidth(Type type) {
+    if (auto bitsType = mlir::dyn_cast<P4HIR::BitsType>(type)) return bitsType.getWidth();
+    if (mlir::isa<P4HIR::BoolType>(type)) return 1;
+    return 0;
+}
+
+static bool isSignedType(Type type) {
+    auto bitsType = mlir::dyn_cast<P4HIR::BitsType>(type);
+    return bitsType && bitsType.isSigned();
+}
+
+//===----------------------------------------------------------------------===//
+// ConstOp
+//===----------------------------------------------------------------------===//
+
+void P4HIR::ConstOp::inferResultRanges(ArrayRef<ConstantIntRanges> argRanges,
+                                       SetIntRangeFn setResultRange) {
+    if (auto intAttr = mlir::dyn_cast<P4HIR::IntAttr>(getValue())) {
+        if (getRangeWidth(intAttr.getType()))
+            setResultRange(getResult(), ConstantIntRanges::constant(intAttr.getValue()));
+    } else if (auto boolAttr = mlir::dyn_cast<P4HIR::BoolAttr>(getValue())) {
+        setResultRange(getResult(), ConstantIntRanges::constant(APInt(1, boolAttr.getValue())));
+    }
+}
+
+//===----------------------------------------------------------------------===//
+// CastOp
+//===----------------------------------------------------------------------===//
+
+void P4HIR::CastOp::inferResultRanges(ArrayRef<ConstantIntRanges> argRanges,
+                                      SetIntRangeFn setResultRange) {
+    unsigned srcWidth = getRangeWidth(getSrc().getType());
+    unsigned dstWidth = getRangeWidth(getType());
+    if (!srcWidth || !dstWidth) return;
+
+    const ConstantIntRanges &src = argRanges.front();
+    if (dstWidth < srcWidth)
+        setResultRange(getResult(), truncRange(src, dstWidth));
+    else if (dstWidth > srcWidth)
+        // Width changes extend according to the signedness of the source
+        setResultRange(getResult(), isSignedType(getSrc().getType())
+                                        ? extSIRange(src, dstWidth)
+                                        : extUIRange(src, dstWidth));
+    else
+        setResultRange(getResult(), src);
+}
+
+//===----------------------------------------------------------------------===//
+// UnaryOp
+//===----------------------------------------------------------------------===//
+
+void P4HIR::UnaryOp::inferResultRanges(ArrayRef<ConstantIntRanges> argRanges,
+                                       SetIntRangeFn setResultRange) {
+    unsigned width = getRangeWidth(getType());
+    if (!width) return;
+
+    const ConstantIntRanges &input = argRanges.front();
+    switch (getKind()) {
+        case P4HIR::UnaryOpKind::UPlus:
+            setResultRange(getResult(), input);
+            break;
+        case P4HIR::UnaryOpKind::Neg:
+            setResultRange(getResult(),
+                           inferSub({ConstantIntRanges::constant(APInt::getZero(width)), input}));
+            break;
+        case P4HIR::UnaryOpKind::Cmpl:
+        case P4HIR::UnaryOpKind::LNot:
+            setResultRange(getResult(),
+                           inferXor({input, ConstantIntRanges::constant(APInt::getAllOnes(width))}));
+            break;
+    }
+}
+
+//===----------------------------------------------------------------------===//
+// BinOp
+//===----------------------------------------------------------------------===//
+
+// Saturating operations clamp the result to the type bounds instead of
+// wrapping around, so the bounds of the result are just the saturated bounds
+// of operands.
+static ConstantIntRanges inferSaturating(P4HIR::BinOpKind kind, bool isSigned,
+                                         const ConstantIntRanges &lhs,
+                                         const ConstantIntRanges &rhs) {
+    if (kind == P4HIR::BinOpKind::AddSat) {
+        if (isSigned)
+            return ConstantIntRanges::fromSigned(lhs.smin().sadd_sat(rhs.smin()),
+                                                 lhs.smax().sadd_sat(rhs.smax()));
+        return ConstantIntRanges::fromUnsigned(lhs.umin().uadd_sat(rhs.umin()),
+                                               lhs.umax().uadd_sat(rhs.umax()));
+    }
+
+    if (isSigned)
+        return ConstantIntRanges::fromSigned(lhs.smin().ssub_sat(rhs.smax()),
+                                             lhs.smax().ssub_sat(rhs.smin()));
+    return ConstantIntRanges::fromUnsigned(lhs.umin().usub_sat(rhs.umax()),
+                                           lhs.umax().usub_sat(rhs.umin()));
+}
+
+void P4HIR::BinOp::inferResultRanges(ArrayRef<ConstantIntRanges> argRanges,
+                                     SetIntRangeFn setResultRange) {
+    unsigned width = getRangeWidth(getType());
+    if (!width) return;
+
+    bool isSigned = isSignedType(getType());
+    const ConstantIntRanges &lhs = argRanges[0], &rhs = argRanges[1];
+    switch (getKind()) {
+        case P4HIR::BinOpKind::Add:
+            setResultRange(getResult(), inferAdd(argRanges));
+            break;
+        case P4HIR::BinOpKind::Sub:
+            setResultRange(getResult(), inferSub(argRanges));
+            break;
+        case P4HIR::BinOpKind::Mul:
+            setResultRange(getResult(), inferMul(argRanges));
+            break;
+        case P4HIR::BinOpKind::Div:
+            // Division and modulo are only defined for unsigned values
+            setResultRange(getResult(), isSigned ? ConstantIntRanges::maxRange(width)
+                                                 : inferDivU(argRanges));
+            break;
+        case P4HIR::BinOpKind::Mod:
+            setResultRange(getResult(), isSigned ? ConstantIntRanges::maxRange(width)
+                                                 : inferRemU(argRanges));
+            break;
+        case P4HIR::BinOpKind::AddSat:
+        case P4HIR::BinOpKind::SubSat:
+            setResultRange(getResult(), inferSaturating(getKind(), isSigned, lhs, rhs));
+            break;
+        case P4HIR::BinOpKind::Or:
+            setResultRange(getResult(), inferOr(argRanges));
+            break;
+        case P4HIR::BinOpKind::Xor:
+            setResultRange(getResult(), inferXor(argRanges));
+            break;
+        case P4HIR::BinOpKind::And:
+            setResultRange(getResult(), inferAnd(argRanges));
+            break;
+    }
+}
+
+//===----------------------------------------------------------------------===//
+// ConcatOp
+//===----------------------------------------------------------------------===//
+
+void P4HIR::ConcatOp::inferResultRanges(ArrayRef<ConstantIntRanges> argRanges,
+                                        SetIntRangeFn setResultRange) {
+    unsigned width = getRangeWidth(getType());
+    unsigned rhsWidth = getRangeWidth(getRhs().getType());
+
+    // Left operand occupies the most significant bits, so the unsigned bounds
+    // of the result are formed by concatenation of the unsigned bounds of
+    // operands.
+    const ConstantIntRanges &lhs = argRanges[0], &rhs = argRanges[1];
+    auto concat = [&](const APInt &hi, const APInt &lo) {
+        return hi.zext(width).shl(rhsWidth) | lo.zext(width);
+    };
+    setResultRange(getResult(), ConstantIntRanges::fromUnsigned(concat(lhs.umin(), rhs.umin()),
+                                                                concat(lhs.umax(), rhs.umax())));
+}
+
+//===----------------------------------------------------------------------===//
+// CmpOp
+//===----------------------------------------------------------------------===//
+
+static intrange::CmpPredicate toCmpPredicate(P4HIR::CmpOpKind kind, bool isSigned) {
+    switch (kind) {
+        case P4HIR::CmpOpKind::Lt:
+            return isSigned ? intrange::CmpPredicate::slt : intrange::CmpPredicate::ult;
+        case P4HIR::CmpOpKind::Le:
+            return isSigned ? intrange::CmpPredicate::sle : intrange::CmpPredicate::ule;
+        case P4HIR::CmpOpKind::Gt:
+            return isSigned ? intrange::CmpPredicate::sgt : intrange::CmpPredicate::ugt;
+        case P4HIR::CmpOpKind::Ge:
+            return isSigned ? intrange::CmpPredicate::sge : intrange::CmpPredicate::uge;
+        case P4HIR::CmpOpKind::Eq:
+            return intrange::CmpPredicate::eq;
+        case P4HIR::CmpOpKind::Ne:
+            return intrange::CmpPredicate::ne;
+    }
+    llvm_unreachable("unknown comparison kind");
+}
+
+void P4HIR::CmpOp::inferResultRanges(ArrayRef<ConstantIntRanges> argRanges,
+                                     SetIntRangeFn setResultRange) {
+    Type operandType = getLhs().getType();
+    if (!getRangeWidth(operandType)) return;
+
+    auto pred = toCmpPredicate(getKind(), isSignedType(operandType));
+    if (auto result = evaluatePred(pred, argRanges[0], argRanges[1]))
+        setResultRange(getResult(), ConstantIntRanges::constant(APInt(1, *result)));
+    else
+        setResultRange(getResult(), ConstantIntRanges::maxRange(1));
+}
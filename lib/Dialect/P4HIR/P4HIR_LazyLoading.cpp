@@ -0,0 +1,72 @@
+#include "p4mlir/Dialect/P4HIR/P4HIR_LazyLoading.h"
+
+#include "mlir/Bytecode/BytecodeReader.h"
+#include "mlir/IR/Verifier.h"
+
+using namespace mlir;
+using namespace P4::P4MLIR;
+
+// Functions are the only lazily loaded operations, everything else
+// (including the module body) is loaded immediately
+static bool isLoadedEagerly(Operation *op) { return !mlir::isa<P4HIR::FuncOp>(op); }
+
+P4HIR::LazyModule::LazyModule(std::unique_ptr<BytecodeReader> reader,
+                              OwningOpRef<ModuleOp> module)
+    : reader(std::move(reader)), module(std::move(module)) {}
+
+P4HIR::LazyModule::~LazyModule() = default;
+
+std::unique_ptr<P4HIR::LazyModule> P4HIR::LazyModule::open(llvm::MemoryBufferRef buffer,
+                                                          MLIRContext *context) {
+    auto loc = FileLineColLoc::get(context, buffer.getBufferIdentifier(), 0, 0);
+    if (!isBytecode(buffer)) {
+        emitError(loc, "lazy loading requires MLIR bytecode input");
+        return nullptr;
+    }
+
+    // Function declarations are only verified once their bodies are loaded:
+    // before that they look like declarations, which they are not
+    ParserConfig config(context, /*verifyAfterParse=*/false);
+    auto reader = std::make_unique<BytecodeReader>(buffer, config, /*lazyLoad=*/true);
+
+    Block block;
+    if (failed(reader->readTopLevel(&block, isLoadedEagerly))) return nullptr;
+
+    auto module = mlir::dyn_cast_or_null<ModuleOp>(block.empty() ? nullptr : &block.front());
+    if (!module || !llvm::hasSingleElement(block)) {
+        emitError(loc, "expected a single top-level module in bytecode");
+        return nullptr;
+    }
+    module->remove();
+
+    return std::unique_ptr<LazyModule>(new LazyModule(std::move(reader), module));
+}
+
+bool P4HIR::LazyModule::isMaterialized(FuncOp func) {
+    return !reader || !reader->isMaterializable(func);
+}
+
+LogicalResult P4HIR::LazyModule::materialize(FuncOp func) {
+    if (isMaterialized(func)) return success();
+    if (failed(reader->materialize(func, isLoadedEagerly))) return failure();
+    return mlir::verify(func);
+}
+
+LogicalResult P4HIR::LazyModule::materialize(llvm::StringRef name) {
+    auto func = module->lookupSymbol<FuncOp>(name);
+    if (!func) return module->emitError("unknown function '") << name << "'";
+    return materialize(func);
+}
+
+LogicalResult P4HIR::LazyModule::materializeAll() {
+    if (!reader) return success();
+
+    // Everything is loaded by finalize(), so the reader is not needed anymore
+    auto finalReader = std::move(reader);
+    if (failed(finalReader->finalize([](Operation *) { return true; }))) return failure();
+    return mlir::verify(*module);
+}
+
+int64_t P4HIR::LazyModule::getNumUnmaterialized() const {
+    return reader ? reader->getNumOpsToMaterialize() : 0;
+}
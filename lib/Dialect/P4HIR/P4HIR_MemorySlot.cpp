@@ -0,0 +1,106 @@
+#include "p4mlir/Dialect/P4HIR/P4HIR_Ops.h"
+
+#include "mlir/IR/Builders.h"
+#include "mlir/Interfaces/MemorySlotInterfaces.h"
+#include "p4mlir/Dialect/P4HIR/P4HIR_Attrs.h"
+#include "p4mlir/Dialect/P4HIR/P4HIR_Types.h"
+
+using namespace mlir;
+using namespace P4::P4MLIR;
+
+//===----------------------------------------------------------------------===//
+// Interfaces for VariableOp
+//===----------------------------------------------------------------------===//
+
+llvm::SmallVector<MemorySlot> P4HIR::VariableOp::getPromotableSlots() {
+    // Only scalars could be represented as SSA values
+    auto objectType = getType().getObjectType();
+    if (!mlir::isa<P4HIR::BitsType, P4HIR::BoolType, P4HIR::InfIntType>(objectType)) return {};
+
+    return {MemorySlot{getResult(), objectType}};
+}
+
+Value P4HIR::VariableOp::getDefaultValue(const MemorySlot &slot, OpBuilder &builder) {
+    // Reading uninitialized variable yields an unspecified value, any constant
+    // is as good as another one.
+    mlir::TypedAttr value;
+    if (auto boolType = mlir::dyn_cast<P4HIR::BoolType>(slot.elemType))
+        value = P4HIR::BoolAttr::get(getContext(), boolType, false);
+    else if (auto bitsType = mlir::dyn_cast<P4HIR::BitsType>(slot.elemType))
+        value = P4HIR::IntAttr::get(bitsType, APInt::getZero(bitsType.getWidth()));
+    else
+        value = P4HIR::IntAttr::get(slot.elemType, APInt::getZero(64));
+
+    return builder.create<P4HIR::ConstOp>(getLoc(), value);
+}
+
+void P4HIR::VariableOp::handleBlockArgument(const MemorySlot &slot, BlockArgument argument,
+                                            OpBuilder &builder) {}
+
+std::optional<PromotableAllocationOpInterface> P4HIR::VariableOp::handlePromotionComplete(
+    const MemorySlot &slot, Value defaultValue, OpBuilder &builder) {
+    if (defaultValue && defaultValue.use_empty()) defaultValue.getDefiningOp()->erase();
+    this->erase();
+    return std::nullopt;
+}
+
+//===----------------------------------------------------------------------===//
+// Interfaces for ReadOp
+//===----------------------------------------------------------------------===//
+
+bool P4HIR::ReadOp::loadsFrom(const MemorySlot &slot) { return getRef() == slot.ptr; }
+
+bool P4HIR::ReadOp::storesTo(const MemorySlot &slot) { return false; }
+
+Value P4HIR::ReadOp::getStored(const MemorySlot &slot, OpBuilder &builder, Value reachingDef,
+                               const DataLayout &dataLayout) {
+    llvm_unreachable("getStored should not be called on ReadOp");
+}
+
+bool P4HIR::ReadOp::canUsesBeRemoved(const MemorySlot &slot,
+                                     const SmallPtrSetImpl<OpOperand *> &blockingUses,
+                                     SmallVectorImpl<OpOperand *> &newBlockingUses,
+                                     const DataLayout &dataLayout) {
+    if (blockingUses.size() != 1) return false;
+    Value blockingUse = (*blockingUses.begin())->get();
+    return blockingUse == slot.ptr && getRef() == slot.ptr &&
+           getResult().getType() == slot.elemType;
+}
+
+DeletionKind P4HIR::ReadOp::removeBlockingUses(const MemorySlot &slot,
+                                               const SmallPtrSetImpl<OpOperand *> &blockingUses,
+                                               OpBuilder &builder, Value reachingDefinition,
+                                               const DataLayout &dataLayout) {
+    getResult().replaceAllUsesWith(reachingDefinition);
+    return DeletionKind::Delete;
+}
+
+//===----------------------------------------------------------------------===//
+// Interfaces for AssignOp
+//===----------------------------------------------------------------------===//
+
+bool P4HIR::AssignOp::loadsFrom(const MemorySlot &slot) { return false; }
+
+bool P4HIR::AssignOp::storesTo(const MemorySlot &slot) { return getRef() == slot.ptr; }
+
+Value P4HIR::AssignOp::getStored(const MemorySlot &slot, OpBuilder &builder, Value reachingDef,
+                                 const DataLayout &dataLayout) {
+    return getValue();
+}
+
+bool P4HIR::AssignOp::canUsesBeRemoved(const MemorySlot &slot,
+                                       const SmallPtrSetImpl<OpOperand *> &blockingUses,
+                                       SmallVectorImpl<OpOperand *> &newBlockingUses,
+                                       const DataLayout &dataLayout) {
+    if (blockingUses.size() != 1) return false;
+    Value blockingUse = (*blockingUses.begin())->get();
+    return blockingUse == slot.ptr && getRef() == slot.ptr && getValue() != slot.ptr &&
+           getValue().getType() == slot.elemType;
+}
+
+DeletionKind P4HIR::AssignOp::removeBlockingUses(const MemorySlot &slot,
+                                                 const SmallPtrSetImpl<OpOperand *> &blockingUses,
+                                                 OpBuilder &builder, Value reachingDefinition,
+                                                 const DataLayout &dataLayout) {
+    return DeletionKind::Delete;
+}
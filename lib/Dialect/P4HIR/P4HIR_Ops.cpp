@@ -1,10 +1,14 @@
 #include "p4mlir/Dialect/P4HIR/P4HIR_Ops.h"
 
 #include "llvm/Support/LogicalResult.h"
+#include "llvm/Support/MathExtras.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/DialectImplementation.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/PatternMatch.h"
 #include "mlir/IR/SymbolTable.h"
 #include "mlir/Interfaces/FunctionImplementation.h"
+#include "mlir/Transforms/InliningUtils.h"
 #include "p4mlir/Dialect/P4HIR/P4HIR_Attrs.h"
 #include "p4mlir/Dialect/P4HIR/P4HIR_Dialect.h"
 #include "p4mlir/Dialect/P4HIR/P4HIR_OpsEnums.h"
@@ -13,6 +17,170 @@
 using namespace mlir;
 using namespace P4::P4MLIR;
 
+//===----------------------------------------------------------------------===//
+// Folding helpers
+//===----------------------------------------------------------------------===//
+
+// Arbitrary-precision integers are stored as signed values with the width
+// rounded up to a multiple of 64 bits (this is what the translator emits).
+// Normalize the folded values the same way, so equal values are represented by
+// the same attribute.
+static APInt normalizeInfInt(const APInt &value) {
+    unsigned width = llvm::alignTo(std::max(value.getSignificantBits(), 1U), 64);
+    return value.sextOrTrunc(width);
+}
+
+static bool isSignedIntType(mlir::Type type) {
+    if (auto bitsType = mlir::dyn_cast<P4HIR::BitsType>(type)) return bitsType.isSigned();
+    return mlir::isa<P4HIR::InfIntType>(type);
+}
+
+// Fixed-width arithmetic wraps around, saturating operations clamp to the
+// range of the type. Division and modulo are only folded for non-negative
+// operands and non-zero divisor, everything else is left for the runtime to
+// handle (or for the frontend to diagnose).
+static std::optional<APInt> foldBitsBinOp(P4HIR::BinOpKind kind, bool isSigned, const APInt &lhs,
+                                          const APInt &rhs) {
+    switch (kind) {
+        case P4HIR::BinOpKind::Mul:
+            return lhs * rhs;
+        case P4HIR::BinOpKind::Div:
+        case P4HIR::BinOpKind::Mod:
+            if (rhs.isZero() || (isSigned && (lhs.isNegative() || rhs.isNegative())))
+                return std::nullopt;
+            return kind == P4HIR::BinOpKind::Div ? lhs.udiv(rhs) : lhs.urem(rhs);
+        case P4HIR::BinOpKind::Add:
+            return lhs + rhs;
+        case P4HIR::BinOpKind::Sub:
+            return lhs - rhs;
+        case P4HIR::BinOpKind::AddSat:
+            return isSigned ? lhs.sadd_sat(rhs) : lhs.uadd_sat(rhs);
+        case P4HIR::BinOpKind::SubSat:
+            return isSigned ? lhs.ssub_sat(rhs) : lhs.usub_sat(rhs);
+        case P4HIR::BinOpKind::Or:
+            return lhs | rhs;
+        case P4HIR::BinOpKind::Xor:
+            return lhs ^ rhs;
+        case P4HIR::BinOpKind::And:
+            return lhs & rhs;
+    }
+
+    llvm_unreachable("Unknown BinOp kind?");
+}
+
+// Arbitrary-precision arithmetic never overflows: extend operands enough to
+// hold the exact result. Bitwise and saturating operations are not defined
+// for infint values.
+static std::optional<APInt> foldInfIntBinOp(P4HIR::BinOpKind kind, const APInt &lhs,
+                                            const APInt &rhs) {
+    unsigned width = std::max(lhs.getBitWidth(), rhs.getBitWidth());
+    switch (kind) {
+        case P4HIR::BinOpKind::Mul:
+            width = lhs.getBitWidth() + rhs.getBitWidth();
+            return normalizeInfInt(lhs.sext(width) * rhs.sext(width));
+        case P4HIR::BinOpKind::Div:
+        case P4HIR::BinOpKind::Mod: {
+            if (rhs.isZero() || lhs.isNegative() || rhs.isNegative()) return std::nullopt;
+            APInt l = lhs.sext(width), r = rhs.sext(width);
+            return normalizeInfInt(kind == P4HIR::BinOpKind::Div ? l.sdiv(r) : l.srem(r));
+        }
+        case P4HIR::BinOpKind::Add:
+            return normalizeInfInt(lhs.sext(width + 1) + rhs.sext(width + 1));
+        case P4HIR::BinOpKind::Sub:
+            return normalizeInfInt(lhs.sext(width + 1) - rhs.sext(width + 1));
+        default:
+            return std::nullopt;
+    }
+}
+
+static bool foldIntCmp(P4HIR::CmpOpKind kind, bool isSigned, const APInt &lhs, const APInt &rhs) {
+    switch (kind) {
+        case P4HIR::CmpOpKind::Lt:
+            return isSigned ? lhs.slt(rhs) : lhs.ult(rhs);
+        case P4HIR::CmpOpKind::Le:
+            return isSigned ? lhs.sle(rhs) : lhs.ule(rhs);
+        case P4HIR::CmpOpKind::Gt:
+            return isSigned ? lhs.sgt(rhs) : lhs.ugt(rhs);
+        case P4HIR::CmpOpKind::Ge:
+            return isSigned ? lhs.sge(rhs) : lhs.uge(rhs);
+        case P4HIR::CmpOpKind::Eq:
+            return lhs == rhs;
+        case P4HIR::CmpOpKind::Ne:
+            return lhs != rhs;
+    }
+
+    llvm_unreachable("Unknown CmpOp kind?");
+}
+
+//===----------------------------------------------------------------------===//
+// Canonicalization helpers
+//===----------------------------------------------------------------------===//
+
+// Returns the attribute representing zero (or false) value of the type, or
+// null if there is no such value.
+static mlir::TypedAttr getZeroAttr(mlir::Type type) {
+    if (auto boolType = mlir::dyn_cast<P4HIR::BoolType>(type))
+        return P4HIR::BoolAttr::get(type.getContext(), boolType, false);
+    if (auto bitsType = mlir::dyn_cast<P4HIR::BitsType>(type))
+        return P4HIR::IntAttr::get(bitsType, APInt::getZero(bitsType.getWidth()));
+    return {};
+}
+
+static Value createZeroConstant(OpBuilder &builder, Location loc, mlir::Type type) {
+    return builder.create<P4HIR::ConstOp>(loc, getZeroAttr(type));
+}
+
+static bool isZeroConstant(Value value) {
+    mlir::Attribute attr;
+    if (!matchPattern(value, m_Constant(&attr))) return false;
+
+    if (auto intAttr = mlir::dyn_cast<P4HIR::IntAttr>(attr)) return intAttr.getValue().isZero();
+    if (auto boolAttr = mlir::dyn_cast<P4HIR::BoolAttr>(attr)) return !boolAttr.getValue();
+    return false;
+}
+
+// Returns the comparison producing the negated result of the given one
+static P4HIR::CmpOpKindAttr invertCmpOpKind(OpBuilder &builder, P4HIR::CmpOpKindAttr kind) {
+    auto inverted = [](P4HIR::CmpOpKind kind) {
+        switch (kind) {
+            case P4HIR::CmpOpKind::Lt:
+                return P4HIR::CmpOpKind::Ge;
+            case P4HIR::CmpOpKind::Le:
+                return P4HIR::CmpOpKind::Gt;
+            case P4HIR::CmpOpKind::Gt:
+                return P4HIR::CmpOpKind::Le;
+            case P4HIR::CmpOpKind::Ge:
+                return P4HIR::CmpOpKind::Lt;
+            case P4HIR::CmpOpKind::Eq:
+                return P4HIR::CmpOpKind::Ne;
+            case P4HIR::CmpOpKind::Ne:
+                return P4HIR::CmpOpKind::Eq;
+        }
+        llvm_unreachable("Unknown CmpOp kind?");
+    };
+
+    return P4HIR::CmpOpKindAttr::get(builder.getContext(), inverted(kind.getValue()));
+}
+
+// cast(cast(x : src) : mid) : dst could be replaced with cast(x : src) : dst
+// if the intermediate cast keeps the bits of x observed by the outer one: if
+// only the bits present in both src and mid are kept, or if x is extended
+// the same way in both cases.
+static bool isRedundantIntermediateCast(mlir::Type src, mlir::Type mid, mlir::Type dst) {
+    auto srcType = mlir::dyn_cast<P4HIR::BitsType>(src);
+    auto midType = mlir::dyn_cast<P4HIR::BitsType>(mid);
+    auto dstType = mlir::dyn_cast<P4HIR::BitsType>(dst);
+    if (!srcType || !midType || !dstType) return false;
+
+    if (dstType.getWidth() <= std::min(srcType.getWidth(), midType.getWidth())) return true;
+
+    return srcType.getWidth() <= midType.getWidth() && srcType.isSigned() == midType.isSigned();
+}
+
+namespace {
+#include "P4HIR_Canonicalize.inc"
+}  // namespace
+
 //===----------------------------------------------------------------------===//
 // ConstantOp
 //===----------------------------------------------------------------------===//
@@ -47,6 +215,8 @@ LogicalResult P4HIR::ConstOp::verify() {
     return checkConstantTypes(getOperation(), getType(), getValue());
 }
 
+OpFoldResult P4HIR::ConstOp::fold(FoldAdaptor) { return getValue(); }
+
 void P4HIR::ConstOp::getAsmResultNames(OpAsmSetValueNameFn setNameFn) {
     if (getName() && !getName()->empty()) {
         setNameFn(getResult(), *getName());
@@ -78,6 +248,47 @@ void P4HIR::CastOp::getAsmResultNames(OpAsmSetValueNameFn setNameFn) {
     setNameFn(getResult(), "cast");
 }
 
+OpFoldResult P4HIR::CastOp::fold(FoldAdaptor adaptor) {
+    // Casts to the same type (e.g. coming from typedefs) are no-op
+    if (getSrc().getType() == getType()) return getSrc();
+
+    auto dstType = getType();
+    if (auto intAttr = mlir::dyn_cast_if_present<P4HIR::IntAttr>(adaptor.getSrc())) {
+        const APInt &value = intAttr.getValue();
+        bool isSigned = isSignedIntType(intAttr.getType());
+
+        // Width changes extend according to the signedness of the source
+        if (auto bitsType = mlir::dyn_cast<P4HIR::BitsType>(dstType)) {
+            unsigned width = bitsType.getWidth();
+            return P4HIR::IntAttr::get(
+                bitsType, isSigned ? value.sextOrTrunc(width) : value.zextOrTrunc(width));
+        }
+
+        if (mlir::isa<P4HIR::InfIntType>(dstType))
+            return P4HIR::IntAttr::get(
+                dstType, normalizeInfInt(isSigned ? value : value.zext(value.getBitWidth() + 1)));
+
+        // bit<1> => bool
+        if (auto boolType = mlir::dyn_cast<P4HIR::BoolType>(dstType))
+            return P4HIR::BoolAttr::get(getContext(), boolType, !value.isZero());
+
+        return {};
+    }
+
+    // bool => bit<1>
+    if (auto boolAttr = mlir::dyn_cast_if_present<P4HIR::BoolAttr>(adaptor.getSrc())) {
+        if (auto bitsType = mlir::dyn_cast<P4HIR::BitsType>(dstType))
+            return P4HIR::IntAttr::get(bitsType, APInt(bitsType.getWidth(), boolAttr.getValue()));
+    }
+
+    return {};
+}
+
+void P4HIR::CastOp::getCanonicalizationPatterns(RewritePatternSet &results,
+                                                MLIRContext *context) {
+    results.add<CastOfCast>(context);
+}
+
 //===----------------------------------------------------------------------===//
 // ReadOp
 //===----------------------------------------------------------------------===//
@@ -107,6 +318,41 @@ void P4HIR::UnaryOp::getAsmResultNames(OpAsmSetValueNameFn setNameFn) {
     setNameFn(getResult(), stringifyEnum(getKind()));
 }
 
+OpFoldResult P4HIR::UnaryOp::fold(FoldAdaptor adaptor) {
+    if (getKind() == P4HIR::UnaryOpKind::UPlus) return getInput();
+
+    if (auto boolAttr = mlir::dyn_cast_if_present<P4HIR::BoolAttr>(adaptor.getInput())) {
+        if (getKind() == P4HIR::UnaryOpKind::LNot)
+            return P4HIR::BoolAttr::get(getContext(), boolAttr.getType(), !boolAttr.getValue());
+        return {};
+    }
+
+    auto intAttr = mlir::dyn_cast_if_present<P4HIR::IntAttr>(adaptor.getInput());
+    if (!intAttr) return {};
+
+    const APInt &value = intAttr.getValue();
+    if (mlir::isa<P4HIR::InfIntType>(getType())) {
+        if (getKind() == P4HIR::UnaryOpKind::Neg)
+            return P4HIR::IntAttr::get(getType(),
+                                       normalizeInfInt(-value.sext(value.getBitWidth() + 1)));
+        return {};
+    }
+
+    switch (getKind()) {
+        case P4HIR::UnaryOpKind::Neg:
+            return P4HIR::IntAttr::get(getType(), -value);
+        case P4HIR::UnaryOpKind::Cmpl:
+            return P4HIR::IntAttr::get(getType(), ~value);
+        default:
+            return {};
+    }
+}
+
+void P4HIR::UnaryOp::getCanonicalizationPatterns(RewritePatternSet &results,
+                                                 MLIRContext *context) {
+    results.add<CmplOfCmpl, NotOfNot, NegOfNeg, NotOfCmp>(context);
+}
+
 //===----------------------------------------------------------------------===//
 // BinaryOp
 //===----------------------------------------------------------------------===//
@@ -115,6 +361,47 @@ void P4HIR::BinOp::getAsmResultNames(OpAsmSetValueNameFn setNameFn) {
     setNameFn(getResult(), stringifyEnum(getKind()));
 }
 
+OpFoldResult P4HIR::BinOp::fold(FoldAdaptor adaptor) {
+    if (!adaptor.getLhs() || !adaptor.getRhs()) return {};
+
+    if (auto lhsBool = mlir::dyn_cast<P4HIR::BoolAttr>(adaptor.getLhs())) {
+        auto rhsBool = mlir::dyn_cast<P4HIR::BoolAttr>(adaptor.getRhs());
+        if (!rhsBool) return {};
+
+        bool lhs = lhsBool.getValue(), rhs = rhsBool.getValue();
+        switch (getKind()) {
+            case P4HIR::BinOpKind::And:
+                return P4HIR::BoolAttr::get(getContext(), lhsBool.getType(), lhs && rhs);
+            case P4HIR::BinOpKind::Or:
+                return P4HIR::BoolAttr::get(getContext(), lhsBool.getType(), lhs || rhs);
+            case P4HIR::BinOpKind::Xor:
+                return P4HIR::BoolAttr::get(getContext(), lhsBool.getType(), lhs != rhs);
+            default:
+                return {};
+        }
+    }
+
+    auto lhsInt = mlir::dyn_cast<P4HIR::IntAttr>(adaptor.getLhs());
+    auto rhsInt = mlir::dyn_cast<P4HIR::IntAttr>(adaptor.getRhs());
+    if (!lhsInt || !rhsInt) return {};
+
+    std::optional<APInt> result;
+    if (auto bitsType = mlir::dyn_cast<P4HIR::BitsType>(getType()))
+        result =
+            foldBitsBinOp(getKind(), bitsType.isSigned(), lhsInt.getValue(), rhsInt.getValue());
+    else if (mlir::isa<P4HIR::InfIntType>(getType()))
+        result = foldInfIntBinOp(getKind(), lhsInt.getValue(), rhsInt.getValue());
+
+    if (!result) return {};
+    return P4HIR::IntAttr::get(getType(), *result);
+}
+
+void P4HIR::BinOp::getCanonicalizationPatterns(RewritePatternSet &results,
+                                               MLIRContext *context) {
+    results.add<XorSelf, AndSelf, OrSelf, AndZeroRhs, AndZeroLhs, OrZeroRhs, XorZeroRhs, AddZeroRhs,
+                SubZeroRhs, OrZeroLhs, XorZeroLhs, AddZeroLhs>(context);
+}
+
 //===----------------------------------------------------------------------===//
 // ConcatOp
 //===----------------------------------------------------------------------===//
@@ -136,6 +423,14 @@ LogicalResult P4HIR::ConcatOp::verify() {
     return success();
 }
 
+OpFoldResult P4HIR::ConcatOp::fold(FoldAdaptor adaptor) {
+    auto lhs = mlir::dyn_cast_if_present<P4HIR::IntAttr>(adaptor.getLhs());
+    auto rhs = mlir::dyn_cast_if_present<P4HIR::IntAttr>(adaptor.getRhs());
+    if (!lhs || !rhs) return {};
+
+    return P4HIR::IntAttr::get(getType(), lhs.getValue().concat(rhs.getValue()));
+}
+
 //===----------------------------------------------------------------------===//
 // CmpOp
 //===----------------------------------------------------------------------===//
@@ -144,6 +439,57 @@ void P4HIR::CmpOp::getAsmResultNames(OpAsmSetValueNameFn setNameFn) {
     setNameFn(getResult(), stringifyEnum(getKind()));
 }
 
+OpFoldResult P4HIR::CmpOp::fold(FoldAdaptor adaptor) {
+    auto resultType = mlir::cast<P4HIR::BoolType>(getType());
+
+    // x cmp x is decided by the comparison kind only
+    if (getLhs() == getRhs()) {
+        switch (getKind()) {
+            case P4HIR::CmpOpKind::Le:
+            case P4HIR::CmpOpKind::Ge:
+            case P4HIR::CmpOpKind::Eq:
+                return P4HIR::BoolAttr::get(getContext(), resultType, true);
+            case P4HIR::CmpOpKind::Lt:
+            case P4HIR::CmpOpKind::Gt:
+            case P4HIR::CmpOpKind::Ne:
+                return P4HIR::BoolAttr::get(getContext(), resultType, false);
+        }
+    }
+
+    if (!adaptor.getLhs() || !adaptor.getRhs()) return {};
+
+    if (auto lhsBool = mlir::dyn_cast<P4HIR::BoolAttr>(adaptor.getLhs())) {
+        auto rhsBool = mlir::dyn_cast<P4HIR::BoolAttr>(adaptor.getRhs());
+        if (!rhsBool) return {};
+
+        switch (getKind()) {
+            case P4HIR::CmpOpKind::Eq:
+                return P4HIR::BoolAttr::get(getContext(), resultType,
+                                            lhsBool.getValue() == rhsBool.getValue());
+            case P4HIR::CmpOpKind::Ne:
+                return P4HIR::BoolAttr::get(getContext(), resultType,
+                                            lhsBool.getValue() != rhsBool.getValue());
+            default:
+                return {};
+        }
+    }
+
+    auto lhsInt = mlir::dyn_cast<P4HIR::IntAttr>(adaptor.getLhs());
+    auto rhsInt = mlir::dyn_cast<P4HIR::IntAttr>(adaptor.getRhs());
+    if (!lhsInt || !rhsInt) return {};
+
+    APInt lhs = lhsInt.getValue(), rhs = rhsInt.getValue();
+    bool isSigned = isSignedIntType(lhsInt.getType());
+    // Infint values might be stored with different widths
+    if (mlir::isa<P4HIR::InfIntType>(lhsInt.getType())) {
+        unsigned width = std::max(lhs.getBitWidth(), rhs.getBitWidth());
+        lhs = lhs.sext(width);
+        rhs = rhs.sext(width);
+    }
+
+    return P4HIR::BoolAttr::get(getContext(), resultType, foldIntCmp(getKind(), isSigned, lhs, rhs));
+}
+
 //===----------------------------------------------------------------------===//
 // VariableOp
 //===----------------------------------------------------------------------===//
@@ -202,6 +548,28 @@ LogicalResult P4HIR::ScopeOp::verify() {
         return emitOpError() << "last block of p4hir.scope must be terminated";
     return success();
 }
+
+// Replaces `op` with the contents of its single-block `region` terminated by
+// p4hir.yield. The values yielded replace the results of `op`.
+static LogicalResult inlineRegionInPlaceOf(Operation *op, Region &region,
+                                           PatternRewriter &rewriter) {
+    if (!region.hasOneBlock()) return failure();
+
+    Block &block = region.front();
+    auto yield = mlir::dyn_cast<P4HIR::YieldOp>(block.getTerminator());
+    if (!yield) return failure();
+
+    // Early returns cannot be moved into the middle of the parent block
+    if (block.walk([](P4HIR::ReturnOp) { return WalkResult::interrupt(); }).wasInterrupted())
+        return failure();
+
+    SmallVector<Value> results(yield.getArgs());
+    rewriter.eraseOp(yield);
+    rewriter.inlineBlockBefore(&block, op);
+    rewriter.replaceOp(op, results);
+    return success();
+}
+
 //===----------------------------------------------------------------------===//
 // Custom Parsers & Printers
 //===----------------------------------------------------------------------===//
@@ -273,6 +641,61 @@ void P4HIR::TernaryOp::getSuccessorRegions(mlir::RegionBranchPoint point,
     regions.push_back(RegionSuccessor(&getFalseRegion()));
 }
 
+void P4HIR::TernaryOp::getEntrySuccessorRegions(ArrayRef<Attribute> operands,
+                                                SmallVectorImpl<RegionSuccessor> &regions) {
+    // Only the taken region is executed if the condition is known.
+    if (auto cond = mlir::dyn_cast_if_present<P4HIR::BoolAttr>(operands.front())) {
+        regions.push_back(RegionSuccessor(cond.getValue() ? &getTrueRegion() : &getFalseRegion()));
+        return;
+    }
+
+    getSuccessorRegions(RegionBranchPoint::parent(), regions);
+}
+
+namespace {
+// Replace ternary with a known condition with the taken region.
+struct FoldConstantTernary : public OpRewritePattern<P4HIR::TernaryOp> {
+    using OpRewritePattern::OpRewritePattern;
+
+    LogicalResult matchAndRewrite(P4HIR::TernaryOp op, PatternRewriter &rewriter) const override {
+        P4HIR::BoolAttr cond;
+        if (!matchPattern(op.getCond(), m_Constant(&cond))) return failure();
+
+        return inlineRegionInPlaceOf(op, cond.getValue() ? op.getTrueRegion() : op.getFalseRegion(),
+                                     rewriter);
+    }
+};
+}  // namespace
+
+// Returns the value yielded from the region if it has no other operations
+static Value getOnlyYieldedValue(Region &region) {
+    if (!region.hasOneBlock()) return nullptr;
+
+    auto yield = mlir::dyn_cast<P4HIR::YieldOp>(region.front().front());
+    if (!yield || yield.getArgs().size() != 1) return nullptr;
+    return yield.getArgs().front();
+}
+
+namespace {
+// Replace ternary yielding the same value from both regions with this value.
+struct FoldTernaryWithSameArms : public OpRewritePattern<P4HIR::TernaryOp> {
+    using OpRewritePattern::OpRewritePattern;
+
+    LogicalResult matchAndRewrite(P4HIR::TernaryOp op, PatternRewriter &rewriter) const override {
+        Value trueValue = getOnlyYieldedValue(op.getTrueRegion());
+        if (!trueValue || trueValue != getOnlyYieldedValue(op.getFalseRegion())) return failure();
+
+        rewriter.replaceOp(op, trueValue);
+        return success();
+    }
+};
+}  // namespace
+
+void P4HIR::TernaryOp::getCanonicalizationPatterns(RewritePatternSet &results,
+                                                   MLIRContext *context) {
+    results.add<FoldConstantTernary, FoldTernaryWithSameArms>(context);
+}
+
 void P4HIR::TernaryOp::build(OpBuilder &builder, OperationState &result, Value cond,
                              function_ref<void(OpBuilder &, Location)> trueBuilder,
                              function_ref<void(OpBuilder &, Location)> falseBuilder) {
@@ -307,6 +730,9 @@ ParseResult P4HIR::IfOp::parse(OpAsmParser &parser, OperationState &result) {
     if (parser.parseOperand(cond) || parser.resolveOperand(cond, boolType, result.operands))
         return failure();
 
+    // Parse the optional result types.
+    if (parser.parseOptionalArrowTypeList(result.types)) return failure();
+
     // Parse the 'then' region.
     auto parseThenLoc = parser.getCurrentLocation();
     if (parser.parseRegion(*thenRegion, /*arguments=*/{},
@@ -326,7 +752,9 @@ ParseResult P4HIR::IfOp::parse(OpAsmParser &parser, OperationState &result) {
 }
 
 void P4HIR::IfOp::print(OpAsmPrinter &p) {
-    p << " " << getCondition() << " ";
+    p << " " << getCondition();
+    if (!getResults().empty()) p.printArrowTypeList(getResultTypes());
+    p << " ";
     auto &thenRegion = this->getThenRegion();
     p.printRegion(thenRegion,
                   /*printEntryBlockArgs=*/false,
@@ -359,7 +787,7 @@ void P4HIR::IfOp::getSuccessorRegions(mlir::RegionBranchPoint point,
                                       SmallVectorImpl<RegionSuccessor> &regions) {
     // The `then` and the `else` region branch back to the parent operation.
     if (!point.isParent()) {
-        regions.push_back(RegionSuccessor());
+        regions.push_back(RegionSuccessor(getResults()));
         return;
     }
 
@@ -369,8 +797,113 @@ void P4HIR::IfOp::getSuccessorRegions(mlir::RegionBranchPoint point,
 
     // If the condition isn't constant, both regions may be executed.
     regions.push_back(RegionSuccessor(&getThenRegion()));
-    // If the else region does not exist, it is not a viable successor.
-    if (elseRegion) regions.push_back(RegionSuccessor(elseRegion));
+    // If the else region does not exist, control flow falls through to the
+    // parent operation instead.
+    if (elseRegion)
+        regions.push_back(RegionSuccessor(elseRegion));
+    else
+        regions.push_back(RegionSuccessor(getResults()));
+}
+
+void P4HIR::IfOp::getEntrySuccessorRegions(ArrayRef<Attribute> operands,
+                                           SmallVectorImpl<RegionSuccessor> &regions) {
+    auto cond = mlir::dyn_cast_if_present<P4HIR::BoolAttr>(operands.front());
+    if (!cond) {
+        getSuccessorRegions(RegionBranchPoint::parent(), regions);
+        return;
+    }
+
+    // Only the taken region is executed if the condition is known.
+    Region *taken = cond.getValue() ? &getThenRegion() : &getElseRegion();
+    if (taken->empty())
+        regions.push_back(RegionSuccessor(getResults()));
+    else
+        regions.push_back(RegionSuccessor(taken));
+}
+
+namespace {
+// Replace if with a known condition with the taken region, or erase it
+// altogether if nothing is executed.
+struct FoldConstantIf : public OpRewritePattern<P4HIR::IfOp> {
+    using OpRewritePattern::OpRewritePattern;
+
+    LogicalResult matchAndRewrite(P4HIR::IfOp op, PatternRewriter &rewriter) const override {
+        P4HIR::BoolAttr cond;
+        if (!matchPattern(op.getCondition(), m_Constant(&cond))) return failure();
+
+        Region &taken = cond.getValue() ? op.getThenRegion() : op.getElseRegion();
+        if (taken.empty()) {
+            rewriter.eraseOp(op);
+            return success();
+        }
+
+        return inlineRegionInPlaceOf(op, taken, rewriter);
+    }
+};
+}  // namespace
+
+// True if the region is absent or has nothing but the terminator
+static bool isEmptyIfRegion(Region &region) {
+    return region.empty() ||
+           (region.hasOneBlock() && mlir::isa<P4HIR::YieldOp>(region.front().front()));
+}
+
+namespace {
+// Simplify if with regions that do nothing: erase if with both regions empty,
+// drop empty else region and negate the condition of if with empty then
+// region.
+struct SimplifyEmptyIfRegions : public OpRewritePattern<P4HIR::IfOp> {
+    using OpRewritePattern::OpRewritePattern;
+
+    LogicalResult matchAndRewrite(P4HIR::IfOp op, PatternRewriter &rewriter) const override {
+        // Regions yielding values are never empty
+        if (!op.getResults().empty()) return failure();
+
+        Region &thenRegion = op.getThenRegion(), &elseRegion = op.getElseRegion();
+        bool thenEmpty = isEmptyIfRegion(thenRegion), elseEmpty = isEmptyIfRegion(elseRegion);
+
+        if (thenEmpty && elseEmpty) {
+            rewriter.eraseOp(op);
+            return success();
+        }
+
+        if (elseEmpty) {
+            if (elseRegion.empty()) return failure();
+            rewriter.eraseBlock(&elseRegion.front());
+            return success();
+        }
+
+        if (!thenEmpty) return failure();
+
+        // if (c) {} else { ... } => if (!c) { ... }
+        auto notOp = rewriter.create<P4HIR::UnaryOp>(op.getLoc(), P4HIR::UnaryOpKind::LNot,
+                                                     op.getCondition());
+        rewriter.eraseBlock(&thenRegion.front());
+        rewriter.inlineRegionBefore(elseRegion, thenRegion, thenRegion.end());
+        rewriter.modifyOpInPlace(op, [&] { op.getConditionMutable().assign(notOp); });
+        return success();
+    }
+};
+}  // namespace
+
+LogicalResult P4HIR::IfOp::verify() {
+    if (!getResults().empty() && getElseRegion().empty())
+        return emitOpError() << "must have an 'else' region when yielding values";
+
+    for (Region *region : {&getThenRegion(), &getElseRegion()})
+        for (Block &block : *region) {
+            if (block.empty()) continue;
+            auto yield = mlir::dyn_cast<P4HIR::YieldOp>(block.back());
+            if (yield && !llvm::equal(yield.getArgs().getTypes(), getResultTypes()))
+                return yield.emitOpError()
+                       << "types of the values yielded do not match the results of p4hir.if";
+        }
+
+    return success();
+}
+
+void P4HIR::IfOp::getCanonicalizationPatterns(RewritePatternSet &results, MLIRContext *context) {
+    results.add<FoldConstantIf, SimplifyEmptyIfRegions>(context);
 }
 
 void P4HIR::IfOp::build(OpBuilder &builder, OperationState &result, Value cond, bool withElseRegion,
@@ -465,6 +998,18 @@ void P4HIR::FuncOp::createEntryBlock() {
 void P4HIR::FuncOp::print(OpAsmPrinter &p) {
     if (getAction()) p << " action";
 
+    // Private visibility is the default one and therefore is omitted
+    switch (SymbolTable::getSymbolVisibility(*this)) {
+        case SymbolTable::Visibility::Public:
+            p << " public";
+            break;
+        case SymbolTable::Visibility::Nested:
+            p << " nested";
+            break;
+        case SymbolTable::Visibility::Private:
+            break;
+    }
+
     // Print function name, signature, and control.
     p << ' ';
     p.printSymbolName(getSymName());
@@ -504,14 +1049,16 @@ ParseResult P4HIR::FuncOp::parse(OpAsmParser &parser, OperationState &state) {
         state.addAttribute(actionNameAttr, parser.getBuilder().getUnitAttr());
     }
 
+    // Parse optional visibility
+    StringRef visibility;
+    if (succeeded(parser.parseOptionalKeyword(&visibility, {"public", "private", "nested"})))
+        state.addAttribute(SymbolTable::getVisibilityAttrName(), builder.getStringAttr(visibility));
+
     // Parse the name as a symbol.
     StringAttr nameAttr;
     if (parser.parseSymbolName(nameAttr, SymbolTable::getSymbolAttrName(), state.attributes))
         return failure();
 
-    // We default to private visibility
-    state.addAttribute(SymbolTable::getVisibilityAttrName(), builder.getStringAttr("private"));
-
     llvm::SmallVector<OpAsmParser::Argument, 8> arguments;
     llvm::SmallVector<DictionaryAttr, 1> resultAttrs;
     llvm::SmallVector<Type, 8> argTypes;
@@ -547,6 +1094,10 @@ ParseResult P4HIR::FuncOp::parse(OpAsmParser &parser, OperationState &state) {
     // If additional attributes are present, parse them.
     if (parser.parseOptionalAttrDictWithKeyword(state.attributes)) return failure();
 
+    // We default to private visibility, unless specified explicitly
+    if (!state.attributes.get(SymbolTable::getVisibilityAttrName()))
+        state.addAttribute(SymbolTable::getVisibilityAttrName(), builder.getStringAttr("private"));
+
     // Add the attributes to the function arguments.
     assert(resultAttrs.size() == resultTypes.size());
     function_interface_impl::addArgAndResultAttrs(builder, state, arguments, resultAttrs,
@@ -611,6 +1162,33 @@ LogicalResult P4HIR::CallOp::verifySymbolUses(SymbolTableCollection &symbolTable
     return success();
 }
 
+using MemoryEffectVector = SmallVectorImpl<SideEffects::EffectInstance<MemoryEffects::Effect>>;
+
+static void addUnknownEffects(MemoryEffectVector &effects) {
+    effects.emplace_back(MemoryEffects::Read::get());
+    effects.emplace_back(MemoryEffects::Write::get());
+}
+
+// Effects of the callee are summarized by p4hir-call-effects pass, so no
+// other function is looked at here.
+void P4HIR::CallOp::getEffects(MemoryEffectVector &effects) {
+    auto summary = (*this)->getAttrOfType<DenseI8ArrayAttr>(getEffectsAttrName());
+    if (!summary || static_cast<unsigned>(summary.size()) != getNumOperands() + 1) {
+        addUnknownEffects(effects);
+        return;
+    }
+
+    for (OpOperand &operand : getOperation()->getOpOperands()) {
+        int8_t mask = summary[operand.getOperandNumber()];
+        if (mask & ReadEffect) effects.emplace_back(MemoryEffects::Read::get(), &operand);
+        if (mask & WriteEffect) effects.emplace_back(MemoryEffects::Write::get(), &operand);
+    }
+
+    int8_t otherMask = summary.asArrayRef().back();
+    if (otherMask & ReadEffect) effects.emplace_back(MemoryEffects::Read::get());
+    if (otherMask & WriteEffect) effects.emplace_back(MemoryEffects::Write::get());
+}
+
 namespace {
 struct P4HIROpAsmDialectInterface : public OpAsmDialectInterface {
     using OpAsmDialectInterface::OpAsmDialectInterface;
@@ -660,6 +1238,174 @@ struct P4HIROpAsmDialectInterface : public OpAsmDialectInterface {
 };
 }  // namespace
 
+Operation *P4HIR::P4HIRDialect::materializeConstant(OpBuilder &builder, Attribute value,
+                                                    Type type, Location loc) {
+    if (!mlir::isa<P4HIR::IntAttr, P4HIR::BoolAttr>(value)) return nullptr;
+
+    auto typedValue = mlir::cast<TypedAttr>(value);
+    if (typedValue.getType() != type) return nullptr;
+
+    return builder.create<P4HIR::ConstOp>(loc, typedValue);
+}
+
+//===----------------------------------------------------------------------===//
+// Inlining
+//===----------------------------------------------------------------------===//
+
+namespace {
+bool hasReturns(Operation *op) {
+    return op->walk([](P4HIR::ReturnOp) { return WalkResult::interrupt(); }).wasInterrupted();
+}
+
+// Early returns could be lowered (see ReturnLowering below) only if the body
+// ends with a return and all the regions containing early returns consist of
+// a single block and do not yield any values.
+bool canLowerReturns(Region &body) {
+    if (!body.hasOneBlock() || body.front().empty() || !isa<P4HIR::ReturnOp>(body.front().back()))
+        return false;
+
+    auto checkRegionOp = [](Operation *op) {
+        if (!mlir::isa<P4HIR::ScopeOp, P4HIR::IfOp>(op) || !hasReturns(op))
+            return WalkResult::advance();
+        if (op->getNumResults() != 0) return WalkResult::interrupt();
+        for (Region &region : op->getRegions())
+            if (!region.empty() && !region.hasOneBlock()) return WalkResult::interrupt();
+        return WalkResult::advance();
+    };
+    return !body.walk(checkRegionOp).wasInterrupted();
+}
+
+// A return nested in p4hir.scope or p4hir.if would exit the caller once the
+// callee is inlined. Convert such returns into structured control flow: each
+// return stores the returned value into a temporary and raises a flag, and
+// the operations following a region that might have returned are guarded by
+// this flag.
+class ReturnLowering {
+ public:
+    ReturnLowering(Block &body, Location loc) : builder(loc.getContext()), body(body), loc(loc) {}
+
+    void run() {
+        auto ret = mlir::cast<P4HIR::ReturnOp>(body.getTerminator());
+        if (ret.hasOperand()) {
+            auto retType = ret.getInput().front().getType();
+            builder.setInsertionPointToStart(&body);
+            retVar = builder.create<P4HIR::VariableOp>(loc, P4HIR::ReferenceType::get(retType),
+                                                       builder.getStringAttr("retval"));
+            builder.setInsertionPoint(ret);
+            builder.create<P4HIR::AssignOp>(loc, ret.getInput().front(), retVar);
+        }
+
+        guardAfterReturns(body);
+
+        if (retVar) {
+            builder.setInsertionPoint(ret);
+            ret->setOperand(0, builder.create<P4HIR::ReadOp>(loc, retVar));
+        }
+    }
+
+ private:
+    Value getFlag() {
+        if (flag) return flag;
+
+        OpBuilder::InsertionGuard guard(builder);
+        builder.setInsertionPointToStart(&body);
+        auto boolType = P4HIR::BoolType::get(builder.getContext());
+        auto var = builder.create<P4HIR::VariableOp>(loc, P4HIR::ReferenceType::get(boolType),
+                                                     builder.getStringAttr("returned"));
+        var.setInit(true);
+        builder.create<P4HIR::AssignOp>(loc, getBoolConstant(false), var);
+        return flag = var;
+    }
+
+    Value getBoolConstant(bool value) {
+        auto boolType = P4HIR::BoolType::get(builder.getContext());
+        return builder.create<P4HIR::ConstOp>(
+            loc, P4HIR::BoolAttr::get(builder.getContext(), boolType, value));
+    }
+
+    void lowerNestedReturn(P4HIR::ReturnOp ret) {
+        builder.setInsertionPoint(ret);
+        if (ret.hasOperand()) builder.create<P4HIR::AssignOp>(loc, ret.getInput().front(), retVar);
+        builder.create<P4HIR::AssignOp>(loc, getBoolConstant(true), getFlag());
+        builder.create<P4HIR::YieldOp>(loc);
+        ret.erase();
+    }
+
+    // Lower the returns nested into the operations of `block` and guard all
+    // the operations following the first one that might return.
+    void guardAfterReturns(Block &block) {
+        for (Operation &op : block.without_terminator()) {
+            if (!hasReturns(&op)) continue;
+
+            for (Region &region : op.getRegions()) {
+                if (region.empty()) continue;
+
+                Block &nested = region.front();
+                if (auto ret = mlir::dyn_cast<P4HIR::ReturnOp>(nested.getTerminator()))
+                    lowerNestedReturn(ret);
+                guardAfterReturns(nested);
+            }
+
+            // Nothing to guard
+            if (std::next(op.getIterator()) == block.getTerminator()->getIterator()) return;
+
+            builder.setInsertionPointAfter(&op);
+            auto returned = builder.create<P4HIR::ReadOp>(loc, getFlag());
+            auto notReturned =
+                builder.create<P4HIR::UnaryOp>(loc, P4HIR::UnaryOpKind::LNot, returned);
+            auto ifOp = builder.create<P4HIR::IfOp>(loc, notReturned, /*withElseRegion=*/false,
+                                                    P4HIR::buildTerminatedBody);
+
+            Block &thenBlock = ifOp.getThenRegion().front();
+            thenBlock.getOperations().splice(thenBlock.getTerminator()->getIterator(),
+                                             block.getOperations(),
+                                             std::next(ifOp->getIterator()),
+                                             block.getTerminator()->getIterator());
+            guardAfterReturns(thenBlock);
+            return;
+        }
+    }
+
+    OpBuilder builder;
+    Block &body;
+    Location loc;
+    Value retVar, flag;
+};
+
+struct P4HIRInlinerInterface : public DialectInlinerInterface {
+    using DialectInlinerInterface::DialectInlinerInterface;
+
+    bool isLegalToInline(Operation *call, Operation *callable, bool wouldBeCloned) const final {
+        auto callee = mlir::dyn_cast<P4HIR::FuncOp>(callable);
+        return callee && canLowerReturns(callee.getBody());
+    }
+
+    bool isLegalToInline(Region *dest, Region *src, bool wouldBeCloned,
+                         IRMapping &valueMapping) const final {
+        return true;
+    }
+
+    bool isLegalToInline(Operation *op, Region *dest, bool wouldBeCloned,
+                         IRMapping &valueMapping) const final {
+        return true;
+    }
+
+    void processInlinedCallBlocks(Operation *call,
+                                  iterator_range<Region::iterator> inlinedBlocks) const final {
+        // Callee body is always a single block, see isLegalToInline above
+        Block &body = *inlinedBlocks.begin();
+        if (llvm::any_of(body.without_terminator(), [](Operation &op) { return hasReturns(&op); }))
+            ReturnLowering(body, call->getLoc()).run();
+    }
+
+    void handleTerminator(Operation *op, ValueRange valuesToRepl) const final {
+        auto ret = mlir::cast<P4HIR::ReturnOp>(op);
+        for (auto [value, result] : llvm::zip(valuesToRepl, ret.getInput()))
+            value.replaceAllUsesWith(result);
+    }
+};
+}  // namespace
+
 void P4HIR::P4HIRDialect::initialize() {
     registerTypes();
     registerAttributes();
@@ -667,7 +1413,8 @@ void P4HIR::P4HIRDialect::initialize() {
 #define GET_OP_LIST
 #include "p4mlir/Dialect/P4HIR/P4HIR_Ops.cpp.inc"  // NOLINT
         >();
-    addInterfaces<P4HIROpAsmDialectInterface>();
+    addInterfaces<P4HIROpAsmDialectInterface, P4HIRInlinerInterface>();
+    registerBytecodeInterface();
 }
 
 #define GET_OP_CLASSES
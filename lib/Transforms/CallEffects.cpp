@@ -0,0 +1,136 @@
+#include "p4mlir/Transforms/Passes.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "p4mlir/Dialect/P4HIR/P4HIR_Dialect.h"
+#include "p4mlir/Dialect/P4HIR/P4HIR_Ops.h"
+
+using namespace mlir;
+
+namespace P4::P4MLIR {
+#define GEN_PASS_DEF_CALLEFFECTS
+#include "p4mlir/Transforms/Passes.h.inc"
+
+namespace {
+
+// Effects of a function as seen by its callers: a mask of
+// P4HIR::CallOp::EffectMask per parameter and one for any other memory.
+struct EffectSummary {
+    SmallVector<int8_t> params;
+    int8_t other = 0;
+};
+
+// Computes the summaries of all the functions reachable from calls. Every
+// function body is walked once, summaries of callees are reused.
+class CallEffectsAnalysis {
+ public:
+    // Returns nullptr if the effects of the call are unknown.
+    const EffectSummary *lookup(P4HIR::CallOp call) {
+        auto calleeAttr = call.getCalleeAttr();
+        if (!calleeAttr) return nullptr;
+
+        auto callee = symbolTables.lookupNearestSymbolFrom<P4HIR::FuncOp>(call, calleeAttr);
+        if (!callee) return nullptr;
+
+        const EffectSummary *summary = getSummary(callee);
+        if (!summary || summary->params.size() != call.getNumOperands()) return nullptr;
+        return summary;
+    }
+
+ private:
+    const EffectSummary *getSummary(P4HIR::FuncOp func) {
+        if (auto it = summaries.find(func); it != summaries.end()) return it->second.get();
+
+        // Summary is unknown while being computed, so (invalid in P4, but
+        // representable) recursive calls are handled conservatively.
+        summaries[func] = nullptr;
+        if (func.isExternal()) return nullptr;
+
+        auto summary = compute(func);
+        return (summaries[func] = std::move(summary)).get();
+    }
+
+    std::unique_ptr<EffectSummary> compute(P4HIR::FuncOp func) {
+        auto summary = std::make_unique<EffectSummary>();
+        summary->params.resize(func.getNumArguments());
+
+        Block &entry = func.getBody().front();
+        auto addEffect = [&](Value value, int8_t mask) {
+            if (!value) {
+                summary->other |= mask;
+                return;
+            }
+
+            if (auto arg = mlir::dyn_cast<BlockArgument>(value); arg && arg.getOwner() == &entry) {
+                summary->params[arg.getArgNumber()] |= mask;
+                return;
+            }
+
+            // Local variables are not observable by the caller
+            if (value.getDefiningOp<P4HIR::VariableOp>()) return;
+
+            summary->other |= mask;
+        };
+
+        auto visit = [&](Operation *op) {
+            if (auto call = mlir::dyn_cast<P4HIR::CallOp>(op)) {
+                const EffectSummary *callee = lookup(call);
+                if (!callee) return WalkResult::interrupt();
+
+                for (auto [operand, mask] : llvm::zip(call.getArgOperands(), callee->params))
+                    addEffect(operand, mask);
+                summary->other |= callee->other;
+                return WalkResult::advance();
+            }
+
+            // Nested operations are visited by the walk itself
+            if (op->hasTrait<OpTrait::HasRecursiveMemoryEffects>()) return WalkResult::advance();
+
+            // Returns carry no effects on their own, see ReturnOp
+            if (mlir::isa<P4HIR::ReturnOp>(op)) return WalkResult::advance();
+
+            auto memOp = mlir::dyn_cast<MemoryEffectOpInterface>(op);
+            if (!memOp) return WalkResult::interrupt();
+
+            SmallVector<MemoryEffects::EffectInstance> effects;
+            memOp.getEffects(effects);
+            for (const auto &effect : effects)
+                addEffect(effect.getValue(), mlir::isa<MemoryEffects::Read>(effect.getEffect())
+                                                 ? P4HIR::CallOp::ReadEffect
+                                                 : P4HIR::CallOp::WriteEffect);
+            return WalkResult::advance();
+        };
+
+        if (func.getBody().walk(visit).wasInterrupted()) return nullptr;
+        return summary;
+    }
+
+    SymbolTableCollection symbolTables;
+    llvm::DenseMap<Operation *, std::unique_ptr<EffectSummary>> summaries;
+};
+
+struct CallEffectsPass : public impl::CallEffectsBase<CallEffectsPass> {
+    void runOnOperation() override {
+        CallEffectsAnalysis analysis;
+        getOperation()->walk([&](P4HIR::CallOp call) {
+            const EffectSummary *summary = analysis.lookup(call);
+            if (!summary) {
+                call->removeAttr(P4HIR::CallOp::getEffectsAttrName());
+                return;
+            }
+
+            SmallVector<int8_t> masks(summary->params);
+            masks.push_back(summary->other);
+            call->setAttr(P4HIR::CallOp::getEffectsAttrName(),
+                          DenseI8ArrayAttr::get(&getContext(), masks));
+        });
+    }
+};
+
+}  // namespace
+
+std::unique_ptr<Pass> createCallEffectsPass() { return std::make_unique<CallEffectsPass>(); }
+
+}  // namespace P4::P4MLIR
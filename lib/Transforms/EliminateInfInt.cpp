@@ -0,0 +1,166 @@
+#include "p4mlir/Transforms/Passes.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/TypeSwitch.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "p4mlir/Dialect/P4HIR/P4HIR_Attrs.h"
+#include "p4mlir/Dialect/P4HIR/P4HIR_Dialect.h"
+#include "p4mlir/Dialect/P4HIR/P4HIR_Ops.h"
+#include "p4mlir/Dialect/P4HIR/P4HIR_Types.h"
+
+using namespace mlir;
+
+namespace P4::P4MLIR {
+#define GEN_PASS_DEF_ELIMINATEINFINT
+#include "p4mlir/Transforms/Passes.h.inc"
+
+namespace {
+
+bool isInfInt(Type type) { return mlir::isa<P4HIR::InfIntType>(type); }
+
+// Returns true if arbitrary-precision results of 'op' could be recomputed at
+// a fixed width, provided its operands could. This is only the case for
+// operations whose low bits depend only on the low bits of the operands, so
+// truncation could be moved from the use to the leaves (constants and casts
+// from fixed-width values).
+bool isMaterializable(Operation *op) {
+    return llvm::TypeSwitch<Operation *, bool>(op)
+        .Case([](P4HIR::ConstOp constOp) { return mlir::isa<P4HIR::IntAttr>(constOp.getValue()); })
+        .Case([](P4HIR::CastOp castOp) {
+            return mlir::isa<P4HIR::BitsType>(castOp.getSrc().getType());
+        })
+        .Case([](P4HIR::UnaryOp unaryOp) {
+            return unaryOp.getKind() == P4HIR::UnaryOpKind::Neg ||
+                   unaryOp.getKind() == P4HIR::UnaryOpKind::UPlus;
+        })
+        .Case([](P4HIR::BinOp binOp) {
+            switch (binOp.getKind()) {
+                case P4HIR::BinOpKind::Add:
+                case P4HIR::BinOpKind::Sub:
+                case P4HIR::BinOpKind::Mul:
+                case P4HIR::BinOpKind::And:
+                case P4HIR::BinOpKind::Or:
+                case P4HIR::BinOpKind::Xor:
+                    return true;
+                default:
+                    // Division and modulo of truncated values differ from
+                    // truncated quotient / remainder
+                    return false;
+            }
+        })
+        .Default([](Operation *) { return false; });
+}
+
+// Recomputes arbitrary-precision values at fixed-width types
+class InfIntMaterializer {
+ public:
+    explicit InfIntMaterializer(MLIRContext *context) : builder(context) {}
+
+    // Returns 'value' computed at 'type', or null if it cannot be bounded
+    Value materialize(Value value, P4HIR::BitsType type) {
+        std::pair<Value, Type> key(value, type);
+        if (auto it = materialized.find(key); it != materialized.end()) return it->second;
+
+        Operation *def = value.getDefiningOp();
+        if (!def) return nullptr;
+
+        Value result;
+        if (isMaterializable(def)) {
+            SmallVector<Value> operands;
+            for (Value operand : def->getOperands()) {
+                Value materializedOperand =
+                    isInfInt(operand.getType()) ? materialize(operand, type) : operand;
+                if (!materializedOperand) break;
+                operands.push_back(materializedOperand);
+            }
+
+            if (operands.size() == def->getNumOperands()) {
+                builder.setInsertionPoint(def);
+                result = create(def, operands, type);
+            }
+        }
+
+        materialized.try_emplace(key, result);
+        return result;
+    }
+
+ private:
+    Value create(Operation *def, ValueRange operands, P4HIR::BitsType type) {
+        return llvm::TypeSwitch<Operation *, Value>(def)
+            .Case([&](P4HIR::ConstOp constOp) {
+                auto value = mlir::cast<P4HIR::IntAttr>(constOp.getValue()).getValue();
+                return builder.create<P4HIR::ConstOp>(
+                    constOp.getLoc(), P4HIR::IntAttr::get(type, value.sextOrTrunc(type.getWidth())));
+            })
+            .Case([&](P4HIR::CastOp castOp) {
+                return builder.create<P4HIR::CastOp>(castOp.getLoc(), type, operands[0]);
+            })
+            .Case([&](P4HIR::UnaryOp unaryOp) {
+                return builder.create<P4HIR::UnaryOp>(unaryOp.getLoc(), unaryOp.getKind(),
+                                                      operands[0]);
+            })
+            .Case([&](P4HIR::BinOp binOp) {
+                return builder.create<P4HIR::BinOp>(binOp.getLoc(), binOp.getKind(), operands[0],
+                                                    operands[1]);
+            });
+    }
+
+    OpBuilder builder;
+    llvm::DenseMap<std::pair<Value, Type>, Value> materialized;
+};
+
+struct EliminateInfIntPass : public impl::EliminateInfIntBase<EliminateInfIntPass> {
+    void runOnOperation() override {
+        Operation *root = getOperation();
+
+        // Every use of arbitrary-precision value should eventually be a cast
+        // to fixed-width integer type. Recompute the value at this type.
+        SmallVector<P4HIR::CastOp> casts;
+        root->walk([&](P4HIR::CastOp castOp) {
+            if (isInfInt(castOp.getSrc().getType()) &&
+                mlir::isa<P4HIR::BitsType>(castOp.getType()))
+                casts.push_back(castOp);
+        });
+
+        InfIntMaterializer materializer(&getContext());
+        for (auto castOp : casts) {
+            auto type = mlir::cast<P4HIR::BitsType>(castOp.getType());
+            if (Value value = materializer.materialize(castOp.getSrc(), type)) {
+                castOp.replaceAllUsesWith(value);
+                castOp.erase();
+            }
+        }
+
+        // Get rid of arbitrary-precision computations that are no longer used.
+        // Users are visited before the values they use.
+        SmallVector<Operation *> infIntOps;
+        root->walk([&](Operation *op) {
+            if (llvm::any_of(op->getResultTypes(), isInfInt)) infIntOps.push_back(op);
+        });
+        for (Operation *op : llvm::reverse(infIntOps))
+            if (isOpTriviallyDead(op)) op->erase();
+
+        // Report operations that prevent elimination of what remains: ones
+        // that cannot be recomputed at fixed width and ones that use
+        // arbitrary-precision values other than via cast
+        bool failed = false;
+        root->walk([&](Operation *op) {
+            if (isMaterializable(op)) return;
+
+            bool hasInfIntResults = llvm::any_of(op->getResultTypes(), isInfInt);
+            bool isCast = mlir::isa<P4HIR::CastOp>(op) && !hasInfIntResults;
+            if (hasInfIntResults || (!isCast && llvm::any_of(op->getOperandTypes(), isInfInt))) {
+                op->emitError("unable to infer fixed width for arbitrary-precision value");
+                failed = true;
+            }
+        });
+        if (failed) signalPassFailure();
+    }
+};
+
+}  // namespace
+
+std::unique_ptr<Pass> createEliminateInfIntPass() { return std::make_unique<EliminateInfIntPass>(); }
+
+}  // namespace P4::P4MLIR
@@ -0,0 +1,182 @@
+#include "p4mlir/Transforms/Passes.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Interfaces/InferIntRangeInterface.h"
+#include "p4mlir/Dialect/P4HIR/P4HIR_Attrs.h"
+#include "p4mlir/Dialect/P4HIR/P4HIR_Dialect.h"
+#include "p4mlir/Dialect/P4HIR/P4HIR_Ops.h"
+#include "p4mlir/Dialect/P4HIR/P4HIR_Types.h"
+
+using namespace mlir;
+
+namespace P4::P4MLIR {
+#define GEN_PASS_DEF_INTRANGEOPTIMIZATIONS
+#include "p4mlir/Transforms/Passes.h.inc"
+
+namespace {
+
+unsigned getRangeWidth(Type type) {
+    if (auto bitsType = mlir::dyn_cast<P4HIR::BitsType>(type)) return bitsType.getWidth();
+    if (mlir::isa<P4HIR::BoolType>(type)) return 1;
+    return 0;
+}
+
+// A forward walk over structured P4HIR computing the ranges of fixed-width
+// integer and boolean values. Values produced by operations that do not infer
+// ranges (block arguments, reads, calls, etc.) span the whole range of their
+// type. Results of scopes and ternaries are the union of the values yielded by
+// their regions.
+class RangeAnalysis {
+ public:
+    void run(Operation *root) {
+        // Post-order walk visits region contents before the parent op, so
+        // the values yielded are known when visiting scope or ternary.
+        root->walk([&](Operation *op) { visit(op); });
+    }
+
+    std::optional<ConstantIntRanges> lookup(Value value) const {
+        if (auto it = ranges.find(value); it != ranges.end()) return it->second;
+        if (unsigned width = getRangeWidth(value.getType()))
+            return ConstantIntRanges::maxRange(width);
+        return std::nullopt;
+    }
+
+    // Moves the ranges of `op` results to the results of `newOp` replacing
+    // it. Entries of the erased values must not survive: their addresses
+    // could be reused by the values created afterwards.
+    void replace(Operation *op, Operation *newOp) {
+        for (auto [from, to] : llvm::zip(op->getResults(), newOp->getResults())) {
+            auto it = ranges.find(from);
+            if (it == ranges.end()) continue;
+            auto range = it->second;
+            ranges.erase(it);
+            ranges.insert_or_assign(to, range);
+        }
+    }
+
+ private:
+    void visit(Operation *op) {
+        if (auto inferrable = mlir::dyn_cast<InferIntRangeInterface>(op)) {
+            SmallVector<ConstantIntRanges> argRanges;
+            for (Value operand : op->getOperands()) {
+                auto range = lookup(operand);
+                if (!range) return;
+                argRanges.push_back(*range);
+            }
+
+            inferrable.inferResultRanges(argRanges, [&](Value value, const ConstantIntRanges &range) {
+                ranges.insert_or_assign(value, range);
+            });
+            return;
+        }
+
+        if (mlir::isa<P4HIR::ScopeOp, P4HIR::TernaryOp>(op) && op->getNumResults() == 1) {
+            std::optional<ConstantIntRanges> result;
+            for (Region &region : op->getRegions())
+                for (Block &block : region) {
+                    auto yield = mlir::dyn_cast<P4HIR::YieldOp>(block.getTerminator());
+                    if (!yield) continue;
+
+                    auto range = lookup(yield.getArgs().front());
+                    if (!range) return;
+                    result = result ? result->rangeUnion(*range) : *range;
+                }
+
+            if (result) ranges.insert_or_assign(op->getResult(0), *result);
+        }
+    }
+
+    llvm::DenseMap<Value, ConstantIntRanges> ranges;
+};
+
+// Returns true if the result of the wrapping arithmetic operation is always
+// exact for the operand ranges given.
+bool cannotOverflow(P4HIR::BinOpKind kind, bool isSigned, const ConstantIntRanges &lhs,
+                    const ConstantIntRanges &rhs) {
+    bool overflow = false;
+    switch (kind) {
+        case P4HIR::BinOpKind::Add:
+            if (!isSigned) {
+                (void)lhs.umax().uadd_ov(rhs.umax(), overflow);
+                return !overflow;
+            }
+            (void)lhs.smin().sadd_ov(rhs.smin(), overflow);
+            if (overflow) return false;
+            (void)lhs.smax().sadd_ov(rhs.smax(), overflow);
+            return !overflow;
+        case P4HIR::BinOpKind::Sub:
+            if (!isSigned) return lhs.umin().uge(rhs.umax());
+            (void)lhs.smin().ssub_ov(rhs.smax(), overflow);
+            if (overflow) return false;
+            (void)lhs.smax().ssub_ov(rhs.smin(), overflow);
+            return !overflow;
+        case P4HIR::BinOpKind::Mul:
+            if (!isSigned) {
+                (void)lhs.umax().umul_ov(rhs.umax(), overflow);
+                return !overflow;
+            }
+            // Extremes of the product are among the products of the bounds
+            for (const APInt &l : {lhs.smin(), lhs.smax()})
+                for (const APInt &r : {rhs.smin(), rhs.smax()}) {
+                    (void)l.smul_ov(r, overflow);
+                    if (overflow) return false;
+                }
+            return true;
+        default:
+            return false;
+    }
+}
+
+struct IntRangeOptimizationsPass
+    : public impl::IntRangeOptimizationsBase<IntRangeOptimizationsPass> {
+    void runOnOperation() override {
+        RangeAnalysis analysis;
+        analysis.run(getOperation());
+
+        IRRewriter rewriter(&getContext());
+        SmallVector<Operation *> worklist;
+        getOperation()->walk([&](InferIntRangeInterface op) {
+            if (!mlir::isa<P4HIR::ConstOp>(op)) worklist.push_back(op);
+        });
+
+        for (Operation *op : worklist) {
+            // Replace values known to be constant
+            Value result = op->getResult(0);
+            auto range = analysis.lookup(result);
+            if (range && range->getConstantValue()) {
+                APInt value = *range->getConstantValue();
+                mlir::TypedAttr attr;
+                if (auto boolType = mlir::dyn_cast<P4HIR::BoolType>(result.getType()))
+                    attr = P4HIR::BoolAttr::get(&getContext(), boolType, !value.isZero());
+                else
+                    attr = P4HIR::IntAttr::get(result.getType(), value);
+
+                rewriter.setInsertionPoint(op);
+                auto constOp = rewriter.create<P4HIR::ConstOp>(op->getLoc(), attr);
+                analysis.replace(op, constOp);
+                rewriter.replaceOp(op, constOp);
+                continue;
+            }
+
+            // Mark arithmetic that never wraps around
+            auto binOp = mlir::dyn_cast<P4HIR::BinOp>(op);
+            if (!binOp || binOp.getNoOverflow()) continue;
+
+            auto bitsType = mlir::dyn_cast<P4HIR::BitsType>(binOp.getType());
+            if (!bitsType) continue;
+
+            auto lhs = analysis.lookup(binOp.getLhs()), rhs = analysis.lookup(binOp.getRhs());
+            if (cannotOverflow(binOp.getKind(), bitsType.isSigned(), *lhs, *rhs))
+                rewriter.modifyOpInPlace(binOp, [&] { binOp.setNoOverflow(true); });
+        }
+    }
+};
+
+}  // namespace
+
+std::unique_ptr<Pass> createIntRangeOptimizationsPass() {
+    return std::make_unique<IntRangeOptimizationsPass>();
+}
+
+}  // namespace P4::P4MLIR
@@ -0,0 +1,221 @@
+#include "p4mlir/Transforms/Passes.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Interfaces/MemorySlotInterfaces.h"
+#include "p4mlir/Dialect/P4HIR/P4HIR_Dialect.h"
+#include "p4mlir/Dialect/P4HIR/P4HIR_Ops.h"
+#include "p4mlir/Dialect/P4HIR/P4HIR_Types.h"
+
+using namespace mlir;
+
+namespace P4::P4MLIR {
+#define GEN_PASS_DEF_MEM2REG
+#include "p4mlir/Transforms/Passes.h.inc"
+
+namespace {
+
+bool hasReturns(Operation *op) {
+    return op->walk([](P4HIR::ReturnOp) { return WalkResult::interrupt(); }).wasInterrupted();
+}
+
+// Inline the bodies of single-block scopes without early returns into the
+// parent block. Scopes only matter for name resolution in P4 source, so
+// flattening them just exposes the variables defined around them (e.g.
+// copy-in / copy-out temporaries of calls) to promotion.
+void inlineScopes(Operation *root) {
+    SmallVector<P4HIR::ScopeOp> scopes;
+    root->walk([&](P4HIR::ScopeOp scope) { scopes.push_back(scope); });
+
+    // Post-order walk: nested scopes are inlined first
+    IRRewriter rewriter(root->getContext());
+    for (P4HIR::ScopeOp scope : scopes) {
+        Region &region = scope.getScopeRegion();
+        if (!region.hasOneBlock()) continue;
+
+        Block &block = region.front();
+        auto yield = mlir::dyn_cast<P4HIR::YieldOp>(block.getTerminator());
+        if (!yield || hasReturns(scope)) continue;
+
+        SmallVector<Value> results(yield.getArgs());
+        rewriter.eraseOp(yield);
+        rewriter.inlineBlockBefore(&block, scope);
+        rewriter.replaceOp(scope, results);
+    }
+}
+
+// Promotes a single scalar variable to SSA values. Unlike upstream mem2reg,
+// reads and assignments may be nested into single-block regions of
+// p4hir.scope, p4hir.if and p4hir.ternary. The regions are processed in
+// program order keeping track of the current value of the variable; the value
+// assigned inside of p4hir.if is passed out of it as an additional result.
+class VariablePromoter {
+ public:
+    explicit VariablePromoter(P4HIR::VariableOp var) : var(var), builder(var) {}
+
+    // Checks whether the variable could be promoted and collects operations
+    // to be processed.
+    bool analyze() {
+        auto slots = var.getPromotableSlots();
+        if (slots.empty()) return false;
+        slot = slots.front();
+
+        Block *home = var->getBlock();
+        llvm::SmallPtrSet<Operation *, 16> seen;
+        for (OpOperand &use : var.getResult().getUses()) {
+            Operation *user = use.getOwner();
+            bool isWrite = false;
+            if (auto assign = mlir::dyn_cast<P4HIR::AssignOp>(user)) {
+                if (assign.getValue() == slot.ptr) return false;
+                isWrite = true;
+            } else if (!mlir::isa<P4HIR::ReadOp>(user)) {
+                return false;
+            }
+
+            // Record all the operations between the use and the variable
+            for (Operation *op = user;; op = op->getParentOp()) {
+                if (seen.insert(op).second) opsToVisit[op->getBlock()].push_back(op);
+                if (op->getBlock() == home) break;
+
+                Operation *parent = op->getParentOp();
+                if (!isTransparent(parent)) return false;
+                // Only p4hir.if could pass the assigned value out
+                if (isWrite) {
+                    if (!mlir::isa<P4HIR::IfOp>(parent)) return false;
+                    writers.insert(parent);
+                }
+            }
+        }
+
+        return true;
+    }
+
+    void promote() {
+        visitBlock(var->getBlock(), nullptr);
+
+        if (defaultValue && defaultValue.use_empty()) defaultValue.getDefiningOp()->erase();
+        var.erase();
+    }
+
+ private:
+    // The variable is visible in all the regions of these operations and the
+    // control always reaches the end of a region unless it is terminated by
+    // p4hir.return.
+    static bool isTransparent(Operation *op) {
+        if (!llvm::isa_and_present<P4HIR::ScopeOp, P4HIR::IfOp, P4HIR::TernaryOp>(op))
+            return false;
+        return llvm::all_of(op->getRegions(),
+                            [](Region &region) { return region.empty() || region.hasOneBlock(); });
+    }
+
+    // Value of uninitialized variable
+    Value getDefaultValue() {
+        if (!defaultValue) {
+            OpBuilder::InsertionGuard guard(builder);
+            builder.setInsertionPoint(var);
+            defaultValue = var.getDefaultValue(slot, builder);
+        }
+        return defaultValue;
+    }
+
+    // Replaces reads and assignments in the block given the value of the
+    // variable at the beginning of the block. Returns the value at the end of
+    // the block or std::nullopt if the block ends with early return.
+    std::optional<Value> visitBlock(Block *block, Value current) {
+        auto it = opsToVisit.find(block);
+        if (it != opsToVisit.end()) {
+            auto &ops = it->second;
+            llvm::sort(ops, [](Operation *a, Operation *b) { return a->isBeforeInBlock(b); });
+
+            for (Operation *op : ops) {
+                if (auto read = mlir::dyn_cast<P4HIR::ReadOp>(op)) {
+                    read.replaceAllUsesWith(current ? current : getDefaultValue());
+                    read.erase();
+                } else if (auto assign = mlir::dyn_cast<P4HIR::AssignOp>(op)) {
+                    current = assign.getValue();
+                    assign.erase();
+                } else {
+                    current = visitRegionOp(op, current);
+                }
+            }
+        }
+
+        if (mlir::isa<P4HIR::ReturnOp>(block->back())) return std::nullopt;
+        return current;
+    }
+
+    Value visitRegionOp(Operation *op, Value current) {
+        // Values at the end of the regions that fall through to the parent
+        SmallVector<std::pair<Region *, Value>> exits;
+        for (Region &region : op->getRegions()) {
+            if (region.empty()) {
+                exits.emplace_back(&region, current);
+                continue;
+            }
+            if (auto exit = visitBlock(&region.front(), current)) exits.emplace_back(&region, *exit);
+        }
+
+        if (!writers.contains(op) ||
+            llvm::all_of(exits, [&](const auto &exit) { return exit.second == current; }))
+            return current;
+
+        // Yield the value from the regions and add the corresponding result
+        auto ifOp = mlir::cast<P4HIR::IfOp>(op);
+        for (auto [region, value] : exits) {
+            if (region->empty()) {
+                OpBuilder::InsertionGuard guard(builder);
+                builder.createBlock(region);
+                builder.create<P4HIR::YieldOp>(ifOp.getLoc());
+            }
+            Operation *yield = region->front().getTerminator();
+            yield->insertOperands(yield->getNumOperands(), value ? value : getDefaultValue());
+        }
+
+        SmallVector<Type> resultTypes(ifOp->getResultTypes());
+        resultTypes.push_back(slot.elemType);
+
+        OperationState state(ifOp.getLoc(), ifOp->getName());
+        state.addOperands(ifOp->getOperands());
+        state.addAttributes(ifOp->getAttrs());
+        state.addTypes(resultTypes);
+        for (Region &region : ifOp->getRegions()) state.addRegion()->takeBody(region);
+
+        OpBuilder::InsertionGuard guard(builder);
+        builder.setInsertionPoint(ifOp);
+        Operation *newIfOp = builder.create(state);
+        ifOp->replaceAllUsesWith(newIfOp->getResults().drop_back());
+        ifOp->erase();
+        return newIfOp->getResults().back();
+    }
+
+    P4HIR::VariableOp var;
+    MemorySlot slot;
+    OpBuilder builder;
+    Value defaultValue;
+    // Uses of the variable and the operations containing them, per block
+    llvm::DenseMap<Block *, SmallVector<Operation *>> opsToVisit;
+    // Operations with assignments of the variable nested
+    llvm::SmallPtrSet<Operation *, 8> writers;
+};
+
+struct Mem2RegPass : public impl::Mem2RegBase<Mem2RegPass> {
+    void runOnOperation() override {
+        inlineScopes(getOperation());
+
+        SmallVector<P4HIR::VariableOp> vars;
+        getOperation()->walk([&](P4HIR::VariableOp var) { vars.push_back(var); });
+
+        for (P4HIR::VariableOp var : vars) {
+            VariablePromoter promoter(var);
+            if (promoter.analyze()) promoter.promote();
+        }
+    }
+};
+
+}  // namespace
+
+std::unique_ptr<Pass> createMem2RegPass() { return std::make_unique<Mem2RegPass>(); }
+
+}  // namespace P4::P4MLIR
@@ -0,0 +1,262 @@
+#include "p4mlir/Transforms/Passes.h"
+
+#include <climits>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/TypeSwitch.h"
+#include "llvm/Support/KnownBits.h"
+#include "mlir/IR/Builders.h"
+#include "p4mlir/Dialect/P4HIR/P4HIR_Attrs.h"
+#include "p4mlir/Dialect/P4HIR/P4HIR_Dialect.h"
+#include "p4mlir/Dialect/P4HIR/P4HIR_Ops.h"
+#include "p4mlir/Dialect/P4HIR/P4HIR_Types.h"
+
+using namespace mlir;
+
+namespace P4::P4MLIR {
+#define GEN_PASS_DEF_NARROWBITWIDTH
+#include "p4mlir/Transforms/Passes.h.inc"
+
+namespace {
+
+// A forward walk over structured P4HIR computing bits of fixed-width integer
+// values that are known to be zero or one. Values produced by operations that
+// are not modeled (block arguments, reads, calls, etc.) have no known bits.
+// Results of scopes and ternaries keep the bits common for all values yielded
+// by their regions.
+class KnownBitsAnalysis {
+ public:
+    void run(Operation *root) {
+        root->walk([&](Operation *op) { visit(op); });
+    }
+
+    llvm::KnownBits lookup(Value value) const {
+        if (auto it = knownBits.find(value); it != knownBits.end()) return it->second;
+        return llvm::KnownBits(getWidth(value));
+    }
+
+    // The number of low bits that might be non-zero
+    unsigned getActiveWidth(Value value) const {
+        auto known = lookup(value);
+        return std::max(known.getBitWidth() - known.countMinLeadingZeros(), 1U);
+    }
+
+    static unsigned getWidth(Value value) {
+        auto bitsType = mlir::dyn_cast<P4HIR::BitsType>(value.getType());
+        return bitsType ? bitsType.getWidth() : 0;
+    }
+
+    void set(Value value, const llvm::KnownBits &known) { knownBits.insert_or_assign(value, known); }
+
+ private:
+    void visit(Operation *op) {
+        if (op->getNumResults() != 1 || !getWidth(op->getResult(0))) return;
+
+        Value result = op->getResult(0);
+        llvm::TypeSwitch<Operation *>(op)
+            .Case([&](P4HIR::ConstOp constOp) {
+                if (auto intAttr = mlir::dyn_cast<P4HIR::IntAttr>(constOp.getValue()))
+                    set(result, llvm::KnownBits::makeConstant(intAttr.getValue()));
+            })
+            .Case([&](P4HIR::CastOp castOp) {
+                // Only conversions between fixed-width integers are modeled
+                Value src = castOp.getSrc();
+                if (!getWidth(src)) return;
+
+                unsigned width = getWidth(result);
+                auto known = lookup(src);
+                if (width <= known.getBitWidth())
+                    set(result, known.trunc(width));
+                else if (mlir::cast<P4HIR::BitsType>(src.getType()).isSigned())
+                    set(result, known.sext(width));
+                else
+                    set(result, known.zext(width));
+            })
+            .Case([&](P4HIR::ConcatOp concatOp) {
+                set(result, lookup(concatOp.getLhs()).concat(lookup(concatOp.getRhs())));
+            })
+            .Case([&](P4HIR::BinOp binOp) { visitBinOp(binOp); })
+            .Case<P4HIR::ScopeOp, P4HIR::TernaryOp>([&](Operation *op) {
+                std::optional<llvm::KnownBits> common;
+                for (Region &region : op->getRegions())
+                    for (Block &block : region) {
+                        auto yield = mlir::dyn_cast<P4HIR::YieldOp>(block.getTerminator());
+                        if (!yield) continue;
+
+                        auto known = lookup(yield.getArgs().front());
+                        common = common ? common->intersectWith(known) : known;
+                    }
+                if (common) set(result, *common);
+            });
+    }
+
+    void visitBinOp(P4HIR::BinOp binOp) {
+        auto lhs = lookup(binOp.getLhs()), rhs = lookup(binOp.getRhs());
+        unsigned width = lhs.getBitWidth();
+        bool isSigned = mlir::cast<P4HIR::BitsType>(binOp.getType()).isSigned();
+
+        switch (binOp.getKind()) {
+            case P4HIR::BinOpKind::And:
+                set(binOp.getResult(), lhs & rhs);
+                break;
+            case P4HIR::BinOpKind::Or:
+                set(binOp.getResult(), lhs | rhs);
+                break;
+            case P4HIR::BinOpKind::Xor:
+                set(binOp.getResult(), lhs ^ rhs);
+                break;
+            case P4HIR::BinOpKind::Mul:
+                set(binOp.getResult(), llvm::KnownBits::mul(lhs, rhs));
+                break;
+            case P4HIR::BinOpKind::Div:
+                if (!isSigned) set(binOp.getResult(), llvm::KnownBits::udiv(lhs, rhs));
+                break;
+            case P4HIR::BinOpKind::Mod:
+                if (!isSigned) set(binOp.getResult(), llvm::KnownBits::urem(lhs, rhs));
+                break;
+            case P4HIR::BinOpKind::Add: {
+                // A carry could only extend the longest operand by one bit
+                unsigned leadingZeros =
+                    std::min(lhs.countMinLeadingZeros(), rhs.countMinLeadingZeros());
+                if (leadingZeros <= 1) break;
+
+                llvm::KnownBits known(width);
+                known.Zero.setHighBits(leadingZeros - 1);
+                set(binOp.getResult(), known);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    llvm::DenseMap<Value, llvm::KnownBits> knownBits;
+};
+
+P4HIR::BitsType getUnsignedType(MLIRContext *context, unsigned width) {
+    return P4HIR::BitsType::get(context, width, /*isSigned=*/false);
+}
+
+// Returns the low 'width' bits of the unsigned 'value'. Zero extensions of
+// narrower unsigned values are looked through, so no cast chains are created.
+Value truncTo(OpBuilder &builder, Location loc, Value value, unsigned width) {
+    auto type = getUnsignedType(builder.getContext(), width);
+    if (auto cast = value.getDefiningOp<P4HIR::CastOp>()) {
+        Value src = cast.getSrc();
+        auto srcType = mlir::dyn_cast<P4HIR::BitsType>(src.getType());
+        if (srcType && srcType.isUnsigned() && srcType.getWidth() <= width)
+            value = src;
+    }
+
+    if (value.getType() == type) return value;
+    return builder.create<P4HIR::CastOp>(loc, type, value);
+}
+
+// The width the unsigned operation could be computed in without changing the
+// result, given the active widths of its operands.
+unsigned getNarrowWidth(P4HIR::BinOpKind kind, unsigned lhs, unsigned rhs) {
+    switch (kind) {
+        case P4HIR::BinOpKind::And:
+            return std::min(lhs, rhs);
+        case P4HIR::BinOpKind::Or:
+        case P4HIR::BinOpKind::Xor:
+        case P4HIR::BinOpKind::Div:
+        case P4HIR::BinOpKind::Mod:
+            return std::max(lhs, rhs);
+        case P4HIR::BinOpKind::Add:
+            return std::max(lhs, rhs) + 1;
+        case P4HIR::BinOpKind::Mul:
+            return lhs + rhs;
+        default:
+            // Subtraction wraps into the high bits, saturating operations
+            // saturate at the type bounds
+            return UINT_MAX;
+    }
+}
+
+struct NarrowBitWidthPass : public impl::NarrowBitWidthBase<NarrowBitWidthPass> {
+    void runOnOperation() override {
+        KnownBitsAnalysis analysis;
+        analysis.run(getOperation());
+
+        // Only unsigned values are narrowed: their upper bits known to be zero
+        // could be dropped and restored by zero extension.
+        auto isUnsigned = [](Type type) {
+            auto bitsType = mlir::dyn_cast<P4HIR::BitsType>(type);
+            return bitsType && bitsType.isUnsigned();
+        };
+
+        SmallVector<Operation *> worklist;
+        getOperation()->walk([&](Operation *op) {
+            if (auto binOp = mlir::dyn_cast<P4HIR::BinOp>(op)) {
+                if (isUnsigned(binOp.getType())) worklist.push_back(op);
+            } else if (auto cmpOp = mlir::dyn_cast<P4HIR::CmpOp>(op)) {
+                if (isUnsigned(cmpOp.getLhs().getType())) worklist.push_back(op);
+            } else if (auto concatOp = mlir::dyn_cast<P4HIR::ConcatOp>(op)) {
+                if (isUnsigned(concatOp.getLhs().getType())) worklist.push_back(op);
+            }
+        });
+
+        OpBuilder builder(&getContext());
+        for (Operation *op : worklist) {
+            builder.setInsertionPoint(op);
+            Value replacement =
+                llvm::TypeSwitch<Operation *, Value>(op)
+                    .Case<P4HIR::BinOp, P4HIR::CmpOp, P4HIR::ConcatOp>(
+                        [&](auto op) { return narrow(builder, op, analysis); })
+                    .Default([](Operation *) { return nullptr; });
+            if (!replacement) continue;
+
+            // Users of the result might be narrowed as well
+            Value result = op->getResult(0);
+            analysis.set(replacement, analysis.lookup(result));
+            result.replaceAllUsesWith(replacement);
+            op->erase();
+        }
+    }
+
+    static Value narrow(OpBuilder &builder, P4HIR::BinOp binOp, const KnownBitsAnalysis &analysis) {
+        unsigned width = KnownBitsAnalysis::getWidth(binOp.getResult());
+        unsigned narrowWidth =
+            getNarrowWidth(binOp.getKind(), analysis.getActiveWidth(binOp.getLhs()),
+                           analysis.getActiveWidth(binOp.getRhs()));
+        if (narrowWidth >= width) return nullptr;
+
+        auto loc = binOp.getLoc();
+        auto lhs = truncTo(builder, loc, binOp.getLhs(), narrowWidth);
+        auto rhs = truncTo(builder, loc, binOp.getRhs(), narrowWidth);
+        auto narrowOp = builder.create<P4HIR::BinOp>(loc, binOp.getKind(), lhs, rhs);
+        return builder.create<P4HIR::CastOp>(loc, binOp.getType(), narrowOp.getResult());
+    }
+
+    static Value narrow(OpBuilder &builder, P4HIR::CmpOp cmpOp, const KnownBitsAnalysis &analysis) {
+        unsigned width = KnownBitsAnalysis::getWidth(cmpOp.getLhs());
+        unsigned narrowWidth = std::max(analysis.getActiveWidth(cmpOp.getLhs()),
+                                        analysis.getActiveWidth(cmpOp.getRhs()));
+        if (narrowWidth >= width) return nullptr;
+
+        auto loc = cmpOp.getLoc();
+        auto lhs = truncTo(builder, loc, cmpOp.getLhs(), narrowWidth);
+        auto rhs = truncTo(builder, loc, cmpOp.getRhs(), narrowWidth);
+        return builder.create<P4HIR::CmpOp>(loc, cmpOp.getKind(), lhs, rhs);
+    }
+
+    static Value narrow(OpBuilder &builder, P4HIR::ConcatOp concatOp,
+                        const KnownBitsAnalysis &analysis) {
+        unsigned lhsWidth = KnownBitsAnalysis::getWidth(concatOp.getLhs());
+        unsigned narrowWidth = analysis.getActiveWidth(concatOp.getLhs());
+        if (narrowWidth >= lhsWidth) return nullptr;
+
+        // Known zero high bits of the left operand are restored by extension
+        auto loc = concatOp.getLoc();
+        auto lhs = truncTo(builder, loc, concatOp.getLhs(), narrowWidth);
+        auto narrowOp = builder.create<P4HIR::ConcatOp>(loc, lhs, concatOp.getRhs());
+        return builder.create<P4HIR::CastOp>(loc, concatOp.getType(), narrowOp.getResult());
+    }
+};
+
+}  // namespace
+
+std::unique_ptr<Pass> createNarrowBitWidthPass() { return std::make_unique<NarrowBitWidthPass>(); }
+
+}  // namespace P4::P4MLIR
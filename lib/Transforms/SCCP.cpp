@@ -0,0 +1,105 @@
+#include "p4mlir/Transforms/Passes.h"
+
+#include "mlir/Analysis/DataFlow/ConstantPropagationAnalysis.h"
+#include "mlir/Analysis/DataFlow/DeadCodeAnalysis.h"
+#include "mlir/Analysis/DataFlowFramework.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "p4mlir/Dialect/P4HIR/P4HIR_Dialect.h"
+#include "p4mlir/Dialect/P4HIR/P4HIR_Ops.h"
+
+using namespace mlir;
+using namespace mlir::dataflow;
+
+namespace P4::P4MLIR {
+#define GEN_PASS_DEF_SCCP
+#include "p4mlir/Transforms/Passes.h.inc"
+
+namespace {
+
+// Replaces all uses of 'value' with a constant if the analysis proved it to be
+// one.
+LogicalResult replaceWithConstant(DataFlowSolver &solver, OpBuilder &builder, Value value) {
+    const auto *lattice = solver.lookupState<Lattice<ConstantValue>>(value);
+    if (!lattice || lattice->getValue().isUninitialized()) return failure();
+
+    const ConstantValue &latticeValue = lattice->getValue();
+    if (!latticeValue.getConstantValue()) return failure();
+
+    Dialect *dialect = latticeValue.getConstantDialect();
+    if (!dialect) return failure();
+
+    Operation *constOp = dialect->materializeConstant(builder, latticeValue.getConstantValue(),
+                                                      value.getType(), value.getLoc());
+    if (!constOp) return failure();
+
+    value.replaceAllUsesWith(constOp->getResult(0));
+    return success();
+}
+
+// Materializes constants found by the solver, erasing operations that become
+// dead. Blocks that were never reached are left untouched.
+void rewrite(DataFlowSolver &solver, MLIRContext *context, MutableArrayRef<Region> initialRegions) {
+    SmallVector<Block *> worklist;
+    auto addToWorklist = [&](MutableArrayRef<Region> regions) {
+        for (Region &region : regions)
+            for (Block &block : llvm::reverse(region)) worklist.push_back(&block);
+    };
+
+    OpBuilder builder(context);
+    addToWorklist(initialRegions);
+    while (!worklist.empty()) {
+        Block *block = worklist.pop_back_val();
+
+        for (Operation &op : llvm::make_early_inc_range(*block)) {
+            // Constants are already in a good shape
+            if (mlir::isa<P4HIR::ConstOp>(op)) continue;
+
+            builder.setInsertionPoint(&op);
+
+            bool replacedAll = op.getNumResults() != 0;
+            for (Value res : op.getResults())
+                replacedAll &= succeeded(replaceWithConstant(solver, builder, res));
+
+            if (replacedAll && wouldOpBeTriviallyDead(&op)) {
+                assert(op.use_empty() && "expected all uses to be replaced");
+                op.erase();
+                continue;
+            }
+
+            addToWorklist(op.getRegions());
+        }
+
+        builder.setInsertionPointToStart(block);
+        for (BlockArgument arg : block->getArguments())
+            (void)replaceWithConstant(solver, builder, arg);
+    }
+}
+
+struct SCCPPass : public impl::SCCPBase<SCCPPass> {
+    void runOnOperation() override {
+        Operation *op = getOperation();
+
+        DataFlowSolver solver;
+        solver.load<DeadCodeAnalysis>();
+        solver.load<SparseConstantPropagation>();
+        if (failed(solver.initializeAndRun(op))) return signalPassFailure();
+
+        rewrite(solver, op->getContext(), op->getRegions());
+
+        // Now get rid of the regions that are never executed
+        RewritePatternSet patterns(&getContext());
+        P4HIR::IfOp::getCanonicalizationPatterns(patterns, &getContext());
+        P4HIR::TernaryOp::getCanonicalizationPatterns(patterns, &getContext());
+        if (failed(applyPatternsAndFoldGreedily(op, std::move(patterns))))
+            return signalPassFailure();
+    }
+};
+
+}  // namespace
+
+std::unique_ptr<Pass> createSCCPPass() { return std::make_unique<SCCPPass>(); }
+
+}  // namespace P4::P4MLIR
@@ -0,0 +1,45 @@
+// RUN: p4mlir-opt --emit-bytecode %s | p4mlir-opt | FileCheck %s
+
+// Types and attributes survive a round trip through the bytecode
+
+!b8i = !p4hir.bit<8>
+!i16i = !p4hir.int<16>
+!b128i = !p4hir.bit<128>
+
+// CHECK-DAG: = #p4hir.int<42> : !b8i
+// CHECK-DAG: = #p4hir.int<-3> : !i16i
+// CHECK-DAG: = #p4hir.int<340282366920938463463374607431768211455> : !b128i
+// CHECK-DAG: = #p4hir.int<100000000000000000000> : !infint
+// CHECK-DAG: #true = #p4hir.bool<true> : !p4hir.bool
+// CHECK-DAG: #false = #p4hir.bool<false> : !p4hir.bool
+
+// CHECK-LABEL: p4hir.func @consts() -> !b128i
+// CHECK-COUNT-6: p4hir.const
+p4hir.func @consts() -> !b128i {
+  %0 = p4hir.const #p4hir.int<42> : !b8i
+  %1 = p4hir.const #p4hir.int<-3> : !i16i
+  %2 = p4hir.const #p4hir.int<340282366920938463463374607431768211455> : !b128i
+  %3 = p4hir.const #p4hir.int<100000000000000000000> : !p4hir.infint
+  %4 = p4hir.const #p4hir.bool<true> : !p4hir.bool
+  %5 = p4hir.const #p4hir.bool<false> : !p4hir.bool
+  p4hir.return %2 : !b128i
+}
+
+// CHECK-LABEL: p4hir.func action @dirs(%arg0: !p4hir.ref<!b8i> {p4hir.dir = #inout}, %arg1: !i16i {p4hir.dir = #in}, %arg2: !p4hir.ref<!b8i> {p4hir.dir = #out}, %arg3: !p4hir.bool {p4hir.dir = #undir})
+p4hir.func action @dirs(%arg0 : !p4hir.ref<!b8i> {p4hir.dir = #p4hir<dir inout>},
+                        %arg1 : !i16i {p4hir.dir = #p4hir<dir in>},
+                        %arg2 : !p4hir.ref<!b8i> {p4hir.dir = #p4hir<dir out>},
+                        %arg3 : !p4hir.bool {p4hir.dir = #p4hir<dir undir>}) {
+  p4hir.return
+}
+
+// CHECK-LABEL: p4hir.func @ext(!b8i, !infint) -> !p4hir.bool
+p4hir.func @ext(!b8i, !p4hir.infint) -> !p4hir.bool
+
+// CHECK-LABEL: p4hir.func @caller
+// CHECK: p4hir.call @ext(%{{.*}}, %{{.*}}) : (!b8i, !infint) -> !p4hir.bool
+p4hir.func @caller(%arg0 : !b8i) {
+  %0 = p4hir.const #p4hir.int<7> : !p4hir.infint
+  %1 = p4hir.call @ext(%arg0, %0) : (!b8i, !p4hir.infint) -> !p4hir.bool
+  p4hir.return
+}
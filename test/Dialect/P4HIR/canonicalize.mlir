@@ -0,0 +1,146 @@
+// RUN: p4mlir-opt --canonicalize %s | FileCheck %s
+
+!b8i = !p4hir.bit<8>
+!i8i = !p4hir.int<8>
+!b16i = !p4hir.bit<16>
+!b32i = !p4hir.bit<32>
+
+// CHECK-LABEL: p4hir.func @cast_trunc_chain
+// CHECK-NEXT: %[[CAST:.*]] = p4hir.cast(%arg0 : !b32i) : !b8i
+// CHECK-NEXT: p4hir.return %[[CAST]] : !b8i
+p4hir.func @cast_trunc_chain(%arg0 : !b32i) -> !b8i {
+  %0 = p4hir.cast(%arg0 : !b32i) : !b16i
+  %1 = p4hir.cast(%0 : !b16i) : !b8i
+  p4hir.return %1 : !b8i
+}
+
+// CHECK-LABEL: p4hir.func @cast_ext_chain
+// CHECK-NEXT: %[[CAST:.*]] = p4hir.cast(%arg0 : !b8i) : !b32i
+// CHECK-NEXT: p4hir.return %[[CAST]] : !b32i
+p4hir.func @cast_ext_chain(%arg0 : !b8i) -> !b32i {
+  %0 = p4hir.cast(%arg0 : !b8i) : !b16i
+  %1 = p4hir.cast(%0 : !b16i) : !b32i
+  p4hir.return %1 : !b32i
+}
+
+// Truncation drops the bits observed by the extension
+// CHECK-LABEL: p4hir.func @no_cast_trunc_ext
+// CHECK-NEXT: p4hir.cast(%arg0 : !b16i) : !b8i
+// CHECK-NEXT: p4hir.cast(%{{.*}} : !b8i) : !b32i
+p4hir.func @no_cast_trunc_ext(%arg0 : !b16i) -> !b32i {
+  %0 = p4hir.cast(%arg0 : !b16i) : !b8i
+  %1 = p4hir.cast(%0 : !b8i) : !b32i
+  p4hir.return %1 : !b32i
+}
+
+// Signedness change turns zero extension into sign extension
+// CHECK-LABEL: p4hir.func @no_cast_sign_change_ext
+// CHECK-NEXT: p4hir.cast(%arg0 : !b8i) : !i8i
+// CHECK-NEXT: p4hir.cast(%{{.*}} : !i8i) : !b16i
+p4hir.func @no_cast_sign_change_ext(%arg0 : !b8i) -> !b16i {
+  %0 = p4hir.cast(%arg0 : !b8i) : !i8i
+  %1 = p4hir.cast(%0 : !i8i) : !b16i
+  p4hir.return %1 : !b16i
+}
+
+// CHECK-LABEL: p4hir.func @double_cmpl
+// CHECK-NEXT: p4hir.return %arg0 : !b8i
+p4hir.func @double_cmpl(%arg0 : !b8i) -> !b8i {
+  %0 = p4hir.unary(cmpl, %arg0) : !b8i
+  %1 = p4hir.unary(cmpl, %0) : !b8i
+  p4hir.return %1 : !b8i
+}
+
+// CHECK-LABEL: p4hir.func @double_not
+// CHECK-NEXT: p4hir.return %arg0 : !p4hir.bool
+p4hir.func @double_not(%arg0 : !p4hir.bool) -> !p4hir.bool {
+  %0 = p4hir.unary(not, %arg0) : !p4hir.bool
+  %1 = p4hir.unary(not, %0) : !p4hir.bool
+  p4hir.return %1 : !p4hir.bool
+}
+
+// CHECK-LABEL: p4hir.func @not_cmp
+// CHECK-NEXT: %[[CMP:.*]] = p4hir.cmp(ge, %arg0, %arg1) : !b8i, !p4hir.bool
+// CHECK-NEXT: p4hir.return %[[CMP]] : !p4hir.bool
+p4hir.func @not_cmp(%arg0 : !b8i, %arg1 : !b8i) -> !p4hir.bool {
+  %0 = p4hir.cmp(lt, %arg0, %arg1) : !b8i, !p4hir.bool
+  %1 = p4hir.unary(not, %0) : !p4hir.bool
+  p4hir.return %1 : !p4hir.bool
+}
+
+// CHECK-LABEL: p4hir.func @xor_self
+// CHECK-NEXT: %[[C:.*]] = p4hir.const #int0_b8i
+// CHECK-NEXT: p4hir.return %[[C]] : !b8i
+p4hir.func @xor_self(%arg0 : !b8i) -> !b8i {
+  %0 = p4hir.binop(xor, %arg0, %arg0) : !b8i
+  p4hir.return %0 : !b8i
+}
+
+// CHECK-LABEL: p4hir.func @and_zero
+// CHECK-NEXT: %[[C:.*]] = p4hir.const #int0_b8i
+// CHECK-NEXT: p4hir.return %[[C]] : !b8i
+p4hir.func @and_zero(%arg0 : !b8i) -> !b8i {
+  %c0 = p4hir.const #p4hir.int<0> : !b8i
+  %0 = p4hir.binop(and, %c0, %arg0) : !b8i
+  %1 = p4hir.binop(and, %0, %arg0) : !b8i
+  p4hir.return %1 : !b8i
+}
+
+// CHECK-LABEL: p4hir.func @identity
+// CHECK-NEXT: p4hir.return %arg0 : !b8i
+p4hir.func @identity(%arg0 : !b8i) -> !b8i {
+  %c0 = p4hir.const #p4hir.int<0> : !b8i
+  %0 = p4hir.binop(or, %arg0, %c0) : !b8i
+  %1 = p4hir.binop(add, %c0, %0) : !b8i
+  %2 = p4hir.binop(and, %1, %1) : !b8i
+  %3 = p4hir.binop(sub, %2, %c0) : !b8i
+  p4hir.return %3 : !b8i
+}
+
+// CHECK-LABEL: p4hir.func @ternary_same_arms
+// CHECK-NOT: p4hir.ternary
+// CHECK: p4hir.return %arg1 : !b8i
+p4hir.func @ternary_same_arms(%arg0 : !p4hir.bool, %arg1 : !b8i) -> !b8i {
+  %0 = p4hir.ternary(%arg0, true {
+    p4hir.yield %arg1 : !b8i
+  }, false {
+    p4hir.yield %arg1 : !b8i
+  }) : (!p4hir.bool) -> !b8i
+  p4hir.return %0 : !b8i
+}
+
+// CHECK-LABEL: p4hir.func @if_empty
+// CHECK-NEXT: p4hir.return
+p4hir.func @if_empty(%arg0 : !p4hir.bool) {
+  p4hir.if %arg0 {
+  } else {
+  }
+  p4hir.return
+}
+
+// CHECK-LABEL: p4hir.func @if_empty_else
+// CHECK: p4hir.if %arg0 {
+// CHECK-NEXT: p4hir.assign %arg1, %arg2 : <!b8i>
+// CHECK-NEXT: }
+// CHECK-NEXT: p4hir.return
+p4hir.func @if_empty_else(%arg0 : !p4hir.bool, %arg1 : !b8i, %arg2 : !p4hir.ref<!b8i>) {
+  p4hir.if %arg0 {
+    p4hir.assign %arg1, %arg2 : <!b8i>
+  } else {
+  }
+  p4hir.return
+}
+
+// CHECK-LABEL: p4hir.func @if_empty_then
+// CHECK: %[[NOT:.*]] = p4hir.unary(not, %arg0) : !p4hir.bool
+// CHECK-NEXT: p4hir.if %[[NOT]] {
+// CHECK-NEXT: p4hir.assign %arg1, %arg2 : <!b8i>
+// CHECK-NEXT: }
+// CHECK-NEXT: p4hir.return
+p4hir.func @if_empty_then(%arg0 : !p4hir.bool, %arg1 : !b8i, %arg2 : !p4hir.ref<!b8i>) {
+  p4hir.if %arg0 {
+  } else {
+    p4hir.assign %arg1, %arg2 : <!b8i>
+  }
+  p4hir.return
+}
@@ -0,0 +1,107 @@
+// RUN: p4mlir-opt --p4hir-call-effects --cse %s | FileCheck %s
+// RUN: p4mlir-opt --cse %s | FileCheck %s --check-prefix=NOSUMMARY
+
+!b32i = !p4hir.bit<32>
+
+// CHECK-LABEL: p4hir.func @read_read
+// CHECK: %[[VAL:.*]] = p4hir.read %arg0 : <!b32i>
+// CHECK-NOT: p4hir.read
+// CHECK: p4hir.binop(add, %[[VAL]], %[[VAL]]) : !b32i
+p4hir.func @read_read(%arg0 : !p4hir.ref<!b32i>) -> !b32i {
+  %0 = p4hir.read %arg0 : <!b32i>
+  %1 = p4hir.read %arg0 : <!b32i>
+  %2 = p4hir.binop(add, %0, %1) : !b32i
+  p4hir.return %2 : !b32i
+}
+
+// CHECK-LABEL: p4hir.func @read_assign_read
+// CHECK: p4hir.read %arg0
+// CHECK: p4hir.assign
+// CHECK: p4hir.read %arg0
+p4hir.func @read_assign_read(%arg0 : !p4hir.ref<!b32i>, %arg1 : !b32i) -> !b32i {
+  %0 = p4hir.read %arg0 : <!b32i>
+  p4hir.assign %arg1, %arg0 : <!b32i>
+  %1 = p4hir.read %arg0 : <!b32i>
+  %2 = p4hir.binop(add, %0, %1) : !b32i
+  p4hir.return %2 : !b32i
+}
+
+// Effects of region operations are the effects of their bodies.
+// CHECK-LABEL: p4hir.func @read_if_read
+// CHECK: %[[VAL:.*]] = p4hir.read %arg0 : <!b32i>
+// CHECK: p4hir.if
+// CHECK-NOT: p4hir.read
+// CHECK: p4hir.binop(add, %[[VAL]], %[[VAL]]) : !b32i
+p4hir.func @read_if_read(%arg0 : !p4hir.ref<!b32i>, %arg1 : !p4hir.bool) -> !b32i {
+  %0 = p4hir.read %arg0 : <!b32i>
+  p4hir.if %arg1 {
+    %c1 = p4hir.const #p4hir.int<1> : !b32i
+    %add = p4hir.binop(add, %0, %c1) : !b32i
+  }
+  %1 = p4hir.read %arg0 : <!b32i>
+  %2 = p4hir.binop(add, %0, %1) : !b32i
+  p4hir.return %2 : !b32i
+}
+
+// Only touches its own variables and reads an argument
+p4hir.func @local_only(%arg0 : !p4hir.ref<!b32i> {p4hir.dir = #p4hir<dir inout>}) {
+  %0 = p4hir.variable ["tmp"] : <!b32i>
+  %1 = p4hir.read %arg0 : <!b32i>
+  p4hir.assign %1, %0 : <!b32i>
+  p4hir.return
+}
+
+p4hir.func @writes_arg(%arg0 : !p4hir.ref<!b32i> {p4hir.dir = #p4hir<dir inout>}) {
+  %0 = p4hir.const #p4hir.int<1> : !b32i
+  p4hir.assign %0, %arg0 : <!b32i>
+  p4hir.return
+}
+
+p4hir.func @calls_writes_arg(%arg0 : !p4hir.ref<!b32i> {p4hir.dir = #p4hir<dir inout>}) {
+  p4hir.call @writes_arg(%arg0) : (!p4hir.ref<!b32i>) -> ()
+  p4hir.return
+}
+
+p4hir.func @external(!p4hir.ref<!b32i> {p4hir.dir = #p4hir<dir inout>})
+
+// Calls without effects summary read and write any memory.
+// CHECK-LABEL: p4hir.func @call_local_only
+// NOSUMMARY-LABEL: p4hir.func @call_local_only
+// NOSUMMARY: p4hir.read %arg0
+// NOSUMMARY: p4hir.call @local_only
+// NOSUMMARY: p4hir.read %arg0
+// CHECK: %[[VAL:.*]] = p4hir.read %arg0 : <!b32i>
+// CHECK: p4hir.call @local_only
+// CHECK-NOT: p4hir.read
+// CHECK: p4hir.binop(add, %[[VAL]], %[[VAL]]) : !b32i
+p4hir.func @call_local_only(%arg0 : !p4hir.ref<!b32i>) -> !b32i {
+  %0 = p4hir.read %arg0 : <!b32i>
+  p4hir.call @local_only(%arg0) : (!p4hir.ref<!b32i>) -> ()
+  %1 = p4hir.read %arg0 : <!b32i>
+  %2 = p4hir.binop(add, %0, %1) : !b32i
+  p4hir.return %2 : !b32i
+}
+
+// CHECK-LABEL: p4hir.func @call_writes_arg
+// CHECK: p4hir.read %arg0
+// CHECK: p4hir.call @calls_writes_arg
+// CHECK: p4hir.read %arg0
+p4hir.func @call_writes_arg(%arg0 : !p4hir.ref<!b32i>) -> !b32i {
+  %0 = p4hir.read %arg0 : <!b32i>
+  p4hir.call @calls_writes_arg(%arg0) : (!p4hir.ref<!b32i>) -> ()
+  %1 = p4hir.read %arg0 : <!b32i>
+  %2 = p4hir.binop(add, %0, %1) : !b32i
+  p4hir.return %2 : !b32i
+}
+
+// CHECK-LABEL: p4hir.func @call_external
+// CHECK: p4hir.read %arg0
+// CHECK: p4hir.call @external
+// CHECK: p4hir.read %arg0
+p4hir.func @call_external(%arg0 : !p4hir.ref<!b32i>) -> !b32i {
+  %0 = p4hir.read %arg0 : <!b32i>
+  p4hir.call @external(%arg0) : (!p4hir.ref<!b32i>) -> ()
+  %1 = p4hir.read %arg0 : <!b32i>
+  %2 = p4hir.binop(add, %0, %1) : !b32i
+  p4hir.return %2 : !b32i
+}
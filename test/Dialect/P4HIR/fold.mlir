@@ -0,0 +1,145 @@
+// RUN: p4mlir-opt --canonicalize %s | FileCheck %s
+
+!b8i = !p4hir.bit<8>
+!i8i = !p4hir.int<8>
+!b16i = !p4hir.bit<16>
+!b1i = !p4hir.bit<1>
+!infint = !p4hir.infint
+
+// CHECK-LABEL: p4hir.func @fold_add
+// CHECK: %[[C:.*]] = p4hir.const #int44_b8i
+// CHECK-NEXT: p4hir.return %[[C]] : !b8i
+p4hir.func @fold_add() -> !b8i {
+  %0 = p4hir.const #p4hir.int<250> : !b8i
+  %1 = p4hir.const #p4hir.int<50> : !b8i
+  %2 = p4hir.binop(add, %0, %1) : !b8i
+  p4hir.return %2 : !b8i
+}
+
+// CHECK-LABEL: p4hir.func @fold_sadd
+// CHECK: %[[C:.*]] = p4hir.const #int-1_b8i
+// CHECK-NEXT: p4hir.return %[[C]] : !b8i
+p4hir.func @fold_sadd() -> !b8i {
+  %0 = p4hir.const #p4hir.int<250> : !b8i
+  %1 = p4hir.const #p4hir.int<50> : !b8i
+  %2 = p4hir.binop(sadd, %0, %1) : !b8i
+  p4hir.return %2 : !b8i
+}
+
+// CHECK-LABEL: p4hir.func @fold_signed_ssub
+// CHECK: p4hir.const #int-128_i8i
+p4hir.func @fold_signed_ssub() -> !i8i {
+  %0 = p4hir.const #p4hir.int<-100> : !i8i
+  %1 = p4hir.const #p4hir.int<100> : !i8i
+  %2 = p4hir.binop(ssub, %0, %1) : !i8i
+  p4hir.return %2 : !i8i
+}
+
+// CHECK-LABEL: p4hir.func @no_fold_div_by_zero
+// CHECK: p4hir.binop(div
+p4hir.func @no_fold_div_by_zero() -> !b8i {
+  %0 = p4hir.const #p4hir.int<42> : !b8i
+  %1 = p4hir.const #p4hir.int<0> : !b8i
+  %2 = p4hir.binop(div, %0, %1) : !b8i
+  p4hir.return %2 : !b8i
+}
+
+// CHECK-LABEL: p4hir.func @fold_infint
+// CHECK: p4hir.const #int36893488147419103230_infint
+p4hir.func @fold_infint() -> !infint {
+  %0 = p4hir.const #p4hir.int<18446744073709551615> : !infint
+  %1 = p4hir.binop(add, %0, %0) : !infint
+  p4hir.return %1 : !infint
+}
+
+// CHECK-LABEL: p4hir.func @fold_unary
+// CHECK: %[[C:.*]] = p4hir.const #int-43_b8i
+// CHECK-NEXT: p4hir.return %[[C]] : !b8i
+p4hir.func @fold_unary() -> !b8i {
+  %0 = p4hir.const #p4hir.int<42> : !b8i
+  %1 = p4hir.unary(cmpl, %0) : !b8i
+  %2 = p4hir.unary(plus, %1) : !b8i
+  p4hir.return %2 : !b8i
+}
+
+// CHECK-LABEL: p4hir.func @fold_cmp
+// CHECK: %[[C:.*]] = p4hir.const #true
+// CHECK-NEXT: p4hir.return %[[C]] : !p4hir.bool
+p4hir.func @fold_cmp() -> !p4hir.bool {
+  %0 = p4hir.const #p4hir.int<-1> : !i8i
+  %1 = p4hir.const #p4hir.int<1> : !i8i
+  %2 = p4hir.cmp(lt, %0, %1) : !i8i, !p4hir.bool
+  p4hir.return %2 : !p4hir.bool
+}
+
+// CHECK-LABEL: p4hir.func @fold_cmp_self
+// CHECK: %[[C:.*]] = p4hir.const #false
+// CHECK-NEXT: p4hir.return %[[C]] : !p4hir.bool
+p4hir.func @fold_cmp_self(%arg0 : !b8i) -> !p4hir.bool {
+  %0 = p4hir.cmp(ne, %arg0, %arg0) : !b8i, !p4hir.bool
+  p4hir.return %0 : !p4hir.bool
+}
+
+// CHECK-LABEL: p4hir.func @fold_cast
+// CHECK: %[[C:.*]] = p4hir.const #int-1_b16i
+// CHECK-NEXT: p4hir.return %[[C]] : !b16i
+p4hir.func @fold_cast() -> !b16i {
+  %0 = p4hir.const #p4hir.int<-1> : !i8i
+  %1 = p4hir.cast(%0 : !i8i) : !p4hir.int<16>
+  %2 = p4hir.cast(%1 : !p4hir.int<16>) : !b16i
+  p4hir.return %2 : !b16i
+}
+
+// CHECK-LABEL: p4hir.func @fold_cast_bool
+// CHECK: %[[C:.*]] = p4hir.const #int-1_b1i
+// CHECK-NEXT: p4hir.return %[[C]] : !b1i
+p4hir.func @fold_cast_bool() -> !b1i {
+  %0 = p4hir.const #p4hir.bool<true> : !p4hir.bool
+  %1 = p4hir.cast(%0 : !p4hir.bool) : !b1i
+  p4hir.return %1 : !b1i
+}
+
+// CHECK-LABEL: p4hir.func @fold_cast_identity
+// CHECK-NEXT: p4hir.return %arg0 : !b8i
+p4hir.func @fold_cast_identity(%arg0 : !b8i) -> !b8i {
+  %0 = p4hir.cast(%arg0 : !b8i) : !b8i
+  p4hir.return %0 : !b8i
+}
+
+// CHECK-LABEL: p4hir.func @fold_concat
+// CHECK: %[[C:.*]] = p4hir.const #int4660_b16i
+// CHECK-NEXT: p4hir.return %[[C]] : !b16i
+p4hir.func @fold_concat() -> !b16i {
+  %0 = p4hir.const #p4hir.int<18> : !b8i
+  %1 = p4hir.const #p4hir.int<52> : !b8i
+  %2 = p4hir.concat(%0 : !b8i, %1 : !b8i) : !b16i
+  p4hir.return %2 : !b16i
+}
+
+// CHECK-LABEL: p4hir.func @fold_ternary
+// CHECK-NOT: p4hir.ternary
+// CHECK-NEXT: p4hir.return %arg1 : !b8i
+p4hir.func @fold_ternary(%arg0 : !b8i, %arg1 : !b8i) -> !b8i {
+  %false = p4hir.const #p4hir.bool<false> : !p4hir.bool
+  %0 = p4hir.ternary(%false, true {
+    p4hir.yield %arg0 : !b8i
+  }, false {
+    p4hir.yield %arg1 : !b8i
+  }) : (!p4hir.bool) -> !b8i
+  p4hir.return %0 : !b8i
+}
+
+// CHECK-LABEL: p4hir.func @fold_if
+// CHECK-NOT: p4hir.if
+// CHECK-NEXT: p4hir.assign %arg1, %arg0 : <!b8i>
+// CHECK-NEXT: p4hir.return
+p4hir.func @fold_if(%arg0 : !p4hir.ref<!b8i>, %arg1 : !b8i) {
+  %true = p4hir.const #p4hir.bool<true> : !p4hir.bool
+  p4hir.if %true {
+    p4hir.assign %arg1, %arg0 : <!b8i>
+  } else {
+    %c0 = p4hir.const #p4hir.int<0> : !b8i
+    p4hir.assign %c0, %arg0 : <!b8i>
+  }
+  p4hir.return
+}
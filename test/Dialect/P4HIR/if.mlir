@@ -15,3 +15,17 @@ module {
     %29 = p4hir.const #p4hir.bool<true> : !p4hir.bool
   }
 }
+
+// CHECK-LABEL: p4hir.func @if_results
+// CHECK: %{{.*}}:2 = p4hir.if %arg0 -> (!p4hir.bit<8>, !p4hir.bool) {
+// CHECK: p4hir.yield %arg1, %arg0 : !p4hir.bit<8>, !p4hir.bool
+// CHECK: } else {
+p4hir.func @if_results(%arg0 : !p4hir.bool, %arg1 : !p4hir.bit<8>) -> !p4hir.bit<8> {
+  %0:2 = p4hir.if %arg0 -> (!p4hir.bit<8>, !p4hir.bool) {
+    p4hir.yield %arg1, %arg0 : !p4hir.bit<8>, !p4hir.bool
+  } else {
+    %c = p4hir.const #p4hir.int<1> : !p4hir.bit<8>
+    p4hir.yield %c, %arg0 : !p4hir.bit<8>, !p4hir.bool
+  }
+  p4hir.return %0#0 : !p4hir.bit<8>
+}
@@ -0,0 +1,76 @@
+// RUN: p4mlir-opt --inline="default-pipeline=''" %s | FileCheck %s
+
+!b16i = !p4hir.bit<16>
+
+p4hir.func action @incr(%arg0 : !p4hir.ref<!b16i> {p4hir.dir = #p4hir<dir inout>}) {
+  %0 = p4hir.read %arg0 : <!b16i>
+  %c1 = p4hir.const #p4hir.int<1> : !b16i
+  %1 = p4hir.binop(add, %0, %c1) : !b16i
+  p4hir.assign %1, %arg0 : <!b16i>
+  p4hir.return
+}
+
+// Callee is inlined into the copy-in / copy-out scope
+// CHECK-LABEL: p4hir.func action public @call_incr
+// CHECK-NOT: p4hir.call
+// CHECK: p4hir.scope {
+// CHECK:   %[[TMP:.*]] = p4hir.variable ["x_inout_arg", init] : <!b16i>
+// CHECK:   %[[VAL:.*]] = p4hir.read %[[TMP]] : <!b16i>
+// CHECK:   %[[ADD:.*]] = p4hir.binop(add, %[[VAL]], %{{.*}}) : !b16i
+// CHECK:   p4hir.assign %[[ADD]], %[[TMP]] : <!b16i>
+// CHECK:   %[[OUT:.*]] = p4hir.read %[[TMP]] : <!b16i>
+// CHECK:   p4hir.assign %[[OUT]], %arg0 : <!b16i>
+// CHECK: }
+// CHECK: p4hir.return
+p4hir.func action public @call_incr(%arg0 : !p4hir.ref<!b16i> {p4hir.dir = #p4hir<dir inout>}) {
+  p4hir.scope {
+    %tmp = p4hir.variable ["x_inout_arg", init] : <!b16i>
+    %0 = p4hir.read %arg0 : <!b16i>
+    p4hir.assign %0, %tmp : <!b16i>
+    p4hir.call @incr(%tmp) : (!p4hir.ref<!b16i>) -> ()
+    %1 = p4hir.read %tmp : <!b16i>
+    p4hir.assign %1, %arg0 : <!b16i>
+  }
+  p4hir.return
+}
+
+p4hir.func @max(%arg0 : !b16i, %arg1 : !b16i) -> !b16i {
+  %0 = p4hir.cmp(gt, %arg0, %arg1) : !b16i, !p4hir.bool
+  p4hir.if %0 {
+    p4hir.return %arg0 : !b16i
+  }
+  p4hir.return %arg1 : !b16i
+}
+
+// Early returns are converted into structured control flow
+// CHECK-LABEL: p4hir.func public @call_max
+// CHECK-NOT: p4hir.call
+// CHECK-DAG: %[[RETURNED:.*]] = p4hir.variable ["returned", init] : <!p4hir.bool>
+// CHECK-DAG: %[[RETVAL:.*]] = p4hir.variable ["retval"] : <!b16i>
+// CHECK: %[[CMP:.*]] = p4hir.cmp(gt, %arg0, %arg1) : !b16i, !p4hir.bool
+// CHECK: p4hir.if %[[CMP]] {
+// CHECK:   p4hir.assign %arg0, %[[RETVAL]] : <!b16i>
+// CHECK:   p4hir.assign %{{.*}}, %[[RETURNED]] : <!p4hir.bool>
+// CHECK-NOT: p4hir.return
+// CHECK: }
+// CHECK: %[[FLAG:.*]] = p4hir.read %[[RETURNED]] : <!p4hir.bool>
+// CHECK: %[[NOT:.*]] = p4hir.unary(not, %[[FLAG]]) : !p4hir.bool
+// CHECK: p4hir.if %[[NOT]] {
+// CHECK:   p4hir.assign %arg1, %[[RETVAL]] : <!b16i>
+// CHECK: }
+// CHECK: %[[RES:.*]] = p4hir.read %[[RETVAL]] : <!b16i>
+// CHECK: p4hir.return %[[RES]] : !b16i
+p4hir.func public @call_max(%arg0 : !b16i, %arg1 : !b16i) -> !b16i {
+  %0 = p4hir.call @max(%arg0, %arg1) : (!b16i, !b16i) -> !b16i
+  p4hir.return %0 : !b16i
+}
+
+p4hir.func @external(!b16i) -> !b16i
+
+// Declarations cannot be inlined
+// CHECK-LABEL: p4hir.func public @call_external
+// CHECK: p4hir.call @external
+p4hir.func public @call_external(%arg0 : !b16i) -> !b16i {
+  %0 = p4hir.call @external(%arg0) : (!b16i) -> !b16i
+  p4hir.return %0 : !b16i
+}
@@ -0,0 +1,29 @@
+// RUN: p4mlir-opt --emit-bytecode %s -o %t.mlirbc
+// RUN: p4mlir-opt --p4hir-materialize=foo --canonicalize %t.mlirbc | FileCheck %s
+// RUN: not p4mlir-opt --p4hir-materialize=unknown %t.mlirbc 2>&1 | FileCheck %s --check-prefix=UNKNOWN
+// RUN: not p4mlir-opt --p4hir-materialize=foo %s 2>&1 | FileCheck %s --check-prefix=TEXT
+
+// Only the materialized function is canonicalized, the others are written
+// out unchanged
+
+!b8i = !p4hir.bit<8>
+
+// CHECK-LABEL: p4hir.func @foo
+// CHECK-NEXT: p4hir.return %arg0 : !b8i
+p4hir.func @foo(%arg0 : !b8i) -> !b8i {
+  %0 = p4hir.unary(cmpl, %arg0) : !b8i
+  %1 = p4hir.unary(cmpl, %0) : !b8i
+  p4hir.return %1 : !b8i
+}
+
+// CHECK-LABEL: p4hir.func @bar
+// CHECK-NEXT: p4hir.unary(cmpl, %arg0) : !b8i
+// CHECK-NEXT: p4hir.unary(cmpl, %{{.*}}) : !b8i
+p4hir.func @bar(%arg0 : !b8i) -> !b8i {
+  %0 = p4hir.unary(cmpl, %arg0) : !b8i
+  %1 = p4hir.unary(cmpl, %0) : !b8i
+  p4hir.return %1 : !b8i
+}
+
+// UNKNOWN: unknown function 'unknown'
+// TEXT: lazy loading requires MLIR bytecode input
@@ -0,0 +1,56 @@
+// RUN: p4mlir-opt --mem2reg %s | FileCheck %s
+
+!b32i = !p4hir.bit<32>
+
+// CHECK-LABEL: p4hir.func @straight
+// CHECK-NOT: p4hir.variable
+// CHECK-NOT: p4hir.read
+// CHECK: p4hir.return %arg0 : !b32i
+p4hir.func @straight(%arg0 : !b32i) -> !b32i {
+  %0 = p4hir.variable ["x", init] : <!b32i>
+  p4hir.assign %arg0, %0 : <!b32i>
+  %1 = p4hir.read %0 : <!b32i>
+  p4hir.return %1 : !b32i
+}
+
+// CHECK-LABEL: p4hir.func @uninitialized
+// CHECK-NOT: p4hir.variable
+// CHECK: %[[C:.*]] = p4hir.const #int0_b32i
+// CHECK-NEXT: p4hir.return %[[C]] : !b32i
+p4hir.func @uninitialized() -> !b32i {
+  %0 = p4hir.variable ["x"] : <!b32i>
+  %1 = p4hir.read %0 : <!b32i>
+  p4hir.return %1 : !b32i
+}
+
+// CHECK-LABEL: p4hir.func @bool
+// CHECK-NOT: p4hir.variable
+// CHECK: %[[NOT:.*]] = p4hir.unary(not, %arg0) : !p4hir.bool
+// CHECK-NEXT: p4hir.return %[[NOT]] : !p4hir.bool
+p4hir.func @bool(%arg0 : !p4hir.bool) -> !p4hir.bool {
+  %0 = p4hir.variable ["b", init] : <!p4hir.bool>
+  p4hir.assign %arg0, %0 : <!p4hir.bool>
+  %1 = p4hir.read %0 : <!p4hir.bool>
+  %2 = p4hir.unary(not, %1) : !p4hir.bool
+  p4hir.assign %2, %0 : <!p4hir.bool>
+  %3 = p4hir.read %0 : <!p4hir.bool>
+  p4hir.return %3 : !p4hir.bool
+}
+
+// Upstream mem2reg does not look into nested regions, see p4hir-mem2reg pass
+// for that.
+// CHECK-LABEL: p4hir.func @through_scope
+// CHECK: %[[VAR:.*]] = p4hir.variable ["val"] : <!b32i>
+// CHECK: p4hir.scope
+// CHECK: p4hir.read %[[VAR]] : <!b32i>
+p4hir.func @through_scope(%arg0 : !b32i) -> !b32i {
+  %0 = p4hir.variable ["val"] : <!b32i>
+  p4hir.assign %arg0, %0 : <!b32i>
+  p4hir.scope {
+    %1 = p4hir.read %0 : <!b32i>
+    %2 = p4hir.binop(add, %1, %1) : !b32i
+    p4hir.assign %2, %0 : <!b32i>
+  }
+  %3 = p4hir.read %0 : <!b32i>
+  p4hir.return %3 : !b32i
+}
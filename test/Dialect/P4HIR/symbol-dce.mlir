@@ -0,0 +1,36 @@
+// RUN: p4mlir-opt --symbol-dce %s | FileCheck %s
+
+!b16i = !p4hir.bit<16>
+
+// Unused private declarations and actions are removed
+// CHECK-NOT: @unused_extern
+// CHECK-NOT: @unused_action
+p4hir.func @unused_extern(!b16i) -> !b16i
+
+p4hir.func action @unused_action() {
+  p4hir.return
+}
+
+// Private functions used by entry points are kept
+// CHECK-LABEL: p4hir.func @used_extern(!b16i) -> !b16i
+p4hir.func @used_extern(!b16i) -> !b16i
+
+// CHECK-LABEL: p4hir.func @helper
+p4hir.func @helper(%arg0 : !b16i) -> !b16i {
+  %0 = p4hir.call @used_extern(%arg0) : (!b16i) -> !b16i
+  p4hir.return %0 : !b16i
+}
+
+// CHECK-LABEL: p4hir.func action public @entry
+// CHECK: p4hir.call @helper
+p4hir.func action public @entry(%arg0 : !b16i {p4hir.dir = #p4hir<dir undir>}) {
+  %0 = p4hir.call @helper(%arg0) : (!b16i) -> !b16i
+  p4hir.return
+}
+
+// Visibility keyword is parsed and printed back
+// CHECK-LABEL: p4hir.func nested @nested_decl(!b16i)
+p4hir.func nested @nested_decl(!b16i)
+
+// CHECK-LABEL: p4hir.func public @public_decl(!b16i)
+p4hir.func public @public_decl(!b16i)
@@ -0,0 +1,68 @@
+// RUN: p4mlir-opt --p4hir-call-effects %s | FileCheck %s
+
+!b32i = !p4hir.bit<32>
+
+p4hir.func @reads_arg(%arg0 : !p4hir.ref<!b32i> {p4hir.dir = #p4hir<dir in>}) -> !b32i {
+  %0 = p4hir.variable ["tmp"] : <!b32i>
+  %1 = p4hir.read %arg0 : <!b32i>
+  p4hir.assign %1, %0 : <!b32i>
+  p4hir.return %1 : !b32i
+}
+
+p4hir.func @writes_arg(%arg0 : !p4hir.ref<!b32i> {p4hir.dir = #p4hir<dir inout>}) {
+  %0 = p4hir.const #p4hir.int<1> : !b32i
+  p4hir.assign %0, %arg0 : <!b32i>
+  p4hir.return
+}
+
+p4hir.func @external(!p4hir.ref<!b32i> {p4hir.dir = #p4hir<dir inout>})
+
+// Effects of nested calls are mapped to the parameters passed to them.
+// CHECK-LABEL: p4hir.func @both
+// CHECK: p4hir.call @reads_arg(%arg1) {p4hir.effects = array<i8: 1, 0>}
+// CHECK: p4hir.call @writes_arg(%arg0) {p4hir.effects = array<i8: 2, 0>}
+p4hir.func @both(%arg0 : !p4hir.ref<!b32i> {p4hir.dir = #p4hir<dir inout>},
+                 %arg1 : !p4hir.ref<!b32i> {p4hir.dir = #p4hir<dir in>}) {
+  %0 = p4hir.call @reads_arg(%arg1) : (!p4hir.ref<!b32i>) -> !b32i
+  p4hir.call @writes_arg(%arg0) : (!p4hir.ref<!b32i>) -> ()
+  p4hir.return
+}
+
+// CHECK-LABEL: p4hir.func @caller
+// CHECK: p4hir.call @both(%arg0, %arg0) {p4hir.effects = array<i8: 2, 1, 0>}
+// Effects on local variables are not visible to the caller.
+// CHECK: p4hir.call @local(%arg0) {p4hir.effects = array<i8: 1, 0>}
+p4hir.func @caller(%arg0 : !p4hir.ref<!b32i>) {
+  p4hir.call @both(%arg0, %arg0) : (!p4hir.ref<!b32i>, !p4hir.ref<!b32i>) -> ()
+  p4hir.call @local(%arg0) : (!p4hir.ref<!b32i>) -> ()
+  p4hir.return
+}
+
+p4hir.func @local(%arg0 : !p4hir.ref<!b32i> {p4hir.dir = #p4hir<dir in>}) {
+  %0 = p4hir.variable ["copy"] : <!b32i>
+  %1 = p4hir.call @reads_arg(%arg0) : (!p4hir.ref<!b32i>) -> !b32i
+  p4hir.call @writes_arg(%0) : (!p4hir.ref<!b32i>) -> ()
+  p4hir.return
+}
+
+// External and recursive callees get no summary, neither do their callers.
+// CHECK-LABEL: p4hir.func @calls_external
+// CHECK: p4hir.call @external(%arg0) : (!p4hir.ref<!b32i>) -> ()
+p4hir.func @calls_external(%arg0 : !p4hir.ref<!b32i> {p4hir.dir = #p4hir<dir inout>}) {
+  p4hir.call @external(%arg0) : (!p4hir.ref<!b32i>) -> ()
+  p4hir.return
+}
+
+// CHECK-LABEL: p4hir.func @recursive
+// CHECK: p4hir.call @recursive(%arg0) : (!p4hir.ref<!b32i>) -> ()
+p4hir.func @recursive(%arg0 : !p4hir.ref<!b32i> {p4hir.dir = #p4hir<dir inout>}) {
+  p4hir.call @recursive(%arg0) : (!p4hir.ref<!b32i>) -> ()
+  p4hir.return
+}
+
+// CHECK-LABEL: p4hir.func @calls_calls_external
+// CHECK: p4hir.call @calls_external(%arg0) : (!p4hir.ref<!b32i>) -> ()
+p4hir.func @calls_calls_external(%arg0 : !p4hir.ref<!b32i>) {
+  p4hir.call @calls_external(%arg0) : (!p4hir.ref<!b32i>) -> ()
+  p4hir.return
+}
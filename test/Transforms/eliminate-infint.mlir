@@ -0,0 +1,50 @@
+// RUN: p4mlir-opt --p4hir-eliminate-infint --split-input-file --verify-diagnostics %s | FileCheck %s
+
+!b8i = !p4hir.bit<8>
+!i16i = !p4hir.int<16>
+!infint = !p4hir.infint
+
+// CHECK-LABEL: p4hir.func @const
+// CHECK-NOT: !infint
+// CHECK: %[[C:.*]] = p4hir.const #int5_b8i
+// CHECK: p4hir.return %[[C]] : !b8i
+p4hir.func @const() -> !b8i {
+  %0 = p4hir.const #p4hir.int<5> : !infint
+  %1 = p4hir.cast(%0 : !infint) : !b8i
+  p4hir.return %1 : !b8i
+}
+
+// Every use gets its own copy of the computation
+// CHECK-LABEL: p4hir.func @expr
+// CHECK-NOT: !infint
+// CHECK-DAG: %[[C300_8:.*]] = p4hir.const #int44_b8i
+// CHECK-DAG: %[[CM1_8:.*]] = p4hir.const #int-1_b8i
+// CHECK-DAG: %[[C300_16:.*]] = p4hir.const #int300_i16i
+// CHECK-DAG: %[[CM1_16:.*]] = p4hir.const #int-1_i16i
+// CHECK-DAG: p4hir.binop(add, %[[C300_8]], %[[CM1_8]]) : !b8i
+// CHECK-DAG: p4hir.binop(add, %[[C300_16]], %[[CM1_16]]) : !i16i
+p4hir.func @expr() -> !b8i {
+  %0 = p4hir.const #p4hir.int<300> : !infint
+  %1 = p4hir.const #p4hir.int<-1> : !infint
+  %2 = p4hir.binop(add, %0, %1) : !infint
+  %3 = p4hir.cast(%2 : !infint) : !b8i
+  %4 = p4hir.cast(%2 : !infint) : !i16i
+  %5 = p4hir.cast(%4 : !i16i) : !b8i
+  %6 = p4hir.binop(xor, %3, %5) : !b8i
+  p4hir.return %6 : !b8i
+}
+
+// -----
+
+!b8i = !p4hir.bit<8>
+!infint = !p4hir.infint
+
+// Division does not commute with truncation
+p4hir.func @div() -> !b8i {
+  %0 = p4hir.const #p4hir.int<300> : !infint
+  %1 = p4hir.const #p4hir.int<3> : !infint
+  // expected-error @below {{unable to infer fixed width for arbitrary-precision value}}
+  %2 = p4hir.binop(div, %0, %1) : !infint
+  %3 = p4hir.cast(%2 : !infint) : !b8i
+  p4hir.return %3 : !b8i
+}
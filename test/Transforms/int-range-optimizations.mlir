@@ -0,0 +1,107 @@
+// RUN: p4mlir-opt --p4hir-int-range-optimizations %s | FileCheck %s
+
+!b8i = !p4hir.bit<8>
+!b16i = !p4hir.bit<16>
+!i8i = !p4hir.int<8>
+
+// Zero-extended value is always below 256 and the sum cannot overflow
+// CHECK-LABEL: p4hir.func @zext
+// CHECK: %[[X:.*]] = p4hir.cast(%arg0 : !b8i) : !b16i
+// CHECK: p4hir.binop(add, %[[X]], %[[X]]) nooverflow : !b16i
+// CHECK: %[[TRUE:.*]] = p4hir.const #true
+// CHECK: p4hir.return %[[TRUE]] : !p4hir.bool
+p4hir.func @zext(%arg0 : !b8i) -> !p4hir.bool {
+  %x = p4hir.cast(%arg0 : !b8i) : !b16i
+  %sum = p4hir.binop(add, %x, %x) : !b16i
+  %c = p4hir.const #p4hir.int<511> : !b16i
+  %cmp = p4hir.cmp(lt, %sum, %c) : !b16i, !p4hir.bool
+  p4hir.return %cmp : !p4hir.bool
+}
+
+// Arithmetic on unknown values may wrap around
+// CHECK-LABEL: p4hir.func @unknown
+// CHECK: p4hir.binop(add, %arg0, %arg1) : !b16i
+// CHECK: p4hir.cmp(ge
+p4hir.func @unknown(%arg0 : !b16i, %arg1 : !b16i) -> !p4hir.bool {
+  %sum = p4hir.binop(add, %arg0, %arg1) : !b16i
+  %cmp = p4hir.cmp(ge, %sum, %arg0) : !b16i, !p4hir.bool
+  p4hir.return %cmp : !p4hir.bool
+}
+
+// Wrap-around makes the comparison undecided: 250 + [0, 15] is [250, 265] mod 256
+// CHECK-LABEL: p4hir.func @wrap
+// CHECK: p4hir.binop(add, %{{.*}}, %{{.*}}) : !b8i
+// CHECK: p4hir.cmp(ge
+p4hir.func @wrap(%arg0 : !b8i) -> !p4hir.bool {
+  %c15 = p4hir.const #p4hir.int<15> : !b8i
+  %c250 = p4hir.const #p4hir.int<250> : !b8i
+  %n = p4hir.binop(and, %arg0, %c15) : !b8i
+  %sum = p4hir.binop(add, %n, %c250) : !b8i
+  %cmp = p4hir.cmp(ge, %sum, %c250) : !b8i, !p4hir.bool
+  p4hir.return %cmp : !p4hir.bool
+}
+
+// Saturating subtraction of the maximal value is always zero
+// CHECK-LABEL: p4hir.func @saturate
+// CHECK: %[[ZERO:.*]] = p4hir.const #int0_b8i
+// CHECK: p4hir.return %[[ZERO]] : !b8i
+p4hir.func @saturate(%arg0 : !b8i) -> !b8i {
+  %c255 = p4hir.const #p4hir.int<255> : !b8i
+  %res = p4hir.binop(ssub, %arg0, %c255) : !b8i
+  p4hir.return %res : !b8i
+}
+
+// Signed saturating addition of positive value never goes below the operand minimum
+// CHECK-LABEL: p4hir.func @saturate_signed
+// CHECK: %[[FALSE:.*]] = p4hir.const #false
+// CHECK: p4hir.return %[[FALSE]] : !p4hir.bool
+p4hir.func @saturate_signed(%arg0 : !i8i) -> !p4hir.bool {
+  %c100 = p4hir.const #p4hir.int<100> : !i8i
+  %cm50 = p4hir.const #p4hir.int<-50> : !i8i
+  %res = p4hir.binop(sadd, %arg0, %c100) : !i8i
+  %cmp = p4hir.cmp(lt, %res, %cm50) : !i8i, !p4hir.bool
+  p4hir.return %cmp : !p4hir.bool
+}
+
+// Concatenation with zero keeps the value in the lower bits
+// CHECK-LABEL: p4hir.func @concat
+// CHECK: %[[TRUE:.*]] = p4hir.const #true
+// CHECK: p4hir.return %[[TRUE]] : !p4hir.bool
+p4hir.func @concat(%arg0 : !b8i) -> !p4hir.bool {
+  %c0 = p4hir.const #p4hir.int<0> : !b8i
+  %cat = p4hir.concat(%c0 : !b8i, %arg0 : !b8i) : !b16i
+  %c255 = p4hir.const #p4hir.int<255> : !b16i
+  %cmp = p4hir.cmp(le, %cat, %c255) : !b16i, !p4hir.bool
+  p4hir.return %cmp : !p4hir.bool
+}
+
+// Ranges are propagated out of ternary regions
+// CHECK-LABEL: p4hir.func @ternary
+// CHECK: %[[TRUE:.*]] = p4hir.const #true
+// CHECK: p4hir.return %[[TRUE]] : !p4hir.bool
+p4hir.func @ternary(%arg0 : !p4hir.bool) -> !p4hir.bool {
+  %res = p4hir.ternary(%arg0, true {
+    %c1 = p4hir.const #p4hir.int<1> : !b8i
+    p4hir.yield %c1 : !b8i
+  }, false {
+    %c2 = p4hir.const #p4hir.int<2> : !b8i
+    p4hir.yield %c2 : !b8i
+  }) : (!p4hir.bool) -> !b8i
+  %c0 = p4hir.const #p4hir.int<0> : !b8i
+  %cmp = p4hir.cmp(ne, %res, %c0) : !b8i, !p4hir.bool
+  p4hir.return %cmp : !p4hir.bool
+}
+
+// Ranges are kept for the constants replacing folded values
+// CHECK-LABEL: p4hir.func @replaced_operand
+// CHECK: %[[C7:.*]] = p4hir.const #int7_b8i
+// CHECK: p4hir.binop(add, %[[C7]], %{{.*}}) nooverflow : !b8i
+p4hir.func @replaced_operand(%arg0 : !b8i) -> !b8i {
+  %c3 = p4hir.const #p4hir.int<3> : !b8i
+  %c4 = p4hir.const #p4hir.int<4> : !b8i
+  %c15 = p4hir.const #p4hir.int<15> : !b8i
+  %sum = p4hir.binop(add, %c3, %c4) : !b8i
+  %n = p4hir.binop(and, %arg0, %c15) : !b8i
+  %res = p4hir.binop(add, %sum, %n) : !b8i
+  p4hir.return %res : !b8i
+}
@@ -0,0 +1,132 @@
+// RUN: p4mlir-opt --p4hir-mem2reg %s | FileCheck %s
+
+!b32i = !p4hir.bit<32>
+
+// Single-block scopes are flattened, so variables accessed from them could be promoted.
+// CHECK-LABEL: p4hir.func @through_scope
+// CHECK-NOT: p4hir.scope
+// CHECK-NOT: p4hir.variable
+// CHECK: %[[ADD:.*]] = p4hir.binop(add, %arg0, %arg0) : !b32i
+// CHECK-NEXT: p4hir.return %[[ADD]] : !b32i
+p4hir.func @through_scope(%arg0 : !b32i) -> !b32i {
+  %0 = p4hir.variable ["val"] : <!b32i>
+  p4hir.assign %arg0, %0 : <!b32i>
+  p4hir.scope {
+    %1 = p4hir.read %0 : <!b32i>
+    %2 = p4hir.binop(add, %1, %1) : !b32i
+    p4hir.assign %2, %0 : <!b32i>
+  }
+  %3 = p4hir.read %0 : <!b32i>
+  p4hir.return %3 : !b32i
+}
+
+// Value assigned in p4hir.if is yielded from it.
+// CHECK-LABEL: p4hir.func @assign_in_if
+// CHECK-NOT: p4hir.variable
+// CHECK: %[[IF:.*]] = p4hir.if %arg0 -> !b32i {
+// CHECK-NEXT: %[[C1:.*]] = p4hir.const #int1_b32i
+// CHECK-NEXT: p4hir.yield %[[C1]] : !b32i
+// CHECK-NEXT: } else {
+// CHECK-NEXT: p4hir.yield %arg1 : !b32i
+// CHECK-NEXT: }
+// CHECK-NEXT: p4hir.return %[[IF]] : !b32i
+p4hir.func @assign_in_if(%arg0 : !p4hir.bool, %arg1 : !b32i) -> !b32i {
+  %0 = p4hir.variable ["val"] : <!b32i>
+  p4hir.assign %arg1, %0 : <!b32i>
+  p4hir.if %arg0 {
+    %c1 = p4hir.const #p4hir.int<1> : !b32i
+    p4hir.assign %c1, %0 : <!b32i>
+  }
+  %1 = p4hir.read %0 : <!b32i>
+  p4hir.return %1 : !b32i
+}
+
+// Variables assigned in both regions, nested ifs and existing results.
+// CHECK-LABEL: p4hir.func @nested_if
+// CHECK-NOT: p4hir.variable
+// CHECK: %[[IF:.*]]:2 = p4hir.if %arg0 -> (!p4hir.bool, !b32i) {
+// CHECK: %[[INNER:.*]] = p4hir.if %arg0 -> !b32i {
+// CHECK: p4hir.yield %arg1 : !b32i
+// CHECK: p4hir.yield %arg0, %[[INNER]] : !p4hir.bool, !b32i
+// CHECK: } else {
+// CHECK: p4hir.yield %arg0, %{{.*}} : !p4hir.bool, !b32i
+// CHECK: p4hir.return %[[IF]]#1 : !b32i
+p4hir.func @nested_if(%arg0 : !p4hir.bool, %arg1 : !b32i) -> !b32i {
+  %0 = p4hir.variable ["val"] : <!b32i>
+  %r = p4hir.if %arg0 -> !p4hir.bool {
+    p4hir.if %arg0 {
+      p4hir.assign %arg1, %0 : <!b32i>
+    }
+    p4hir.yield %arg0 : !p4hir.bool
+  } else {
+    %c2 = p4hir.const #p4hir.int<2> : !b32i
+    p4hir.assign %c2, %0 : <!b32i>
+    p4hir.yield %arg0 : !p4hir.bool
+  }
+  %1 = p4hir.read %0 : <!b32i>
+  p4hir.return %1 : !b32i
+}
+
+// Reads in ternary regions see the value assigned before.
+// CHECK-LABEL: p4hir.func @read_in_ternary
+// CHECK-NOT: p4hir.variable
+// CHECK: p4hir.ternary(%arg0, true {
+// CHECK-NEXT: p4hir.yield %arg1 : !b32i
+p4hir.func @read_in_ternary(%arg0 : !p4hir.bool, %arg1 : !b32i) -> !b32i {
+  %0 = p4hir.variable ["val"] : <!b32i>
+  p4hir.assign %arg1, %0 : <!b32i>
+  %1 = p4hir.ternary(%arg0, true {
+    %2 = p4hir.read %0 : <!b32i>
+    p4hir.yield %2 : !b32i
+  }, false {
+    p4hir.yield %arg1 : !b32i
+  }) : (!p4hir.bool) -> !b32i
+  p4hir.return %1 : !b32i
+}
+
+// Assignments in ternary regions keep the variable in memory.
+// CHECK-LABEL: p4hir.func @assign_in_ternary
+// CHECK: %[[VAR:.*]] = p4hir.variable ["val"] : <!b32i>
+// CHECK: p4hir.assign %arg1, %[[VAR]] : <!b32i>
+p4hir.func @assign_in_ternary(%arg0 : !p4hir.bool, %arg1 : !b32i) -> !b32i {
+  %0 = p4hir.variable ["val"] : <!b32i>
+  %1 = p4hir.ternary(%arg0, true {
+    p4hir.assign %arg1, %0 : <!b32i>
+    p4hir.yield %arg0 : !p4hir.bool
+  }, false {
+    p4hir.yield %arg0 : !p4hir.bool
+  }) : (!p4hir.bool) -> !p4hir.bool
+  %2 = p4hir.read %0 : <!b32i>
+  p4hir.return %2 : !b32i
+}
+
+// Region ending with early return does not contribute to the value after p4hir.if.
+// CHECK-LABEL: p4hir.func @early_return
+// CHECK-NOT: p4hir.variable
+// CHECK: p4hir.if %arg0 {
+// CHECK: p4hir.return %[[C1:.*]] : !b32i
+// CHECK: }
+// CHECK-NEXT: p4hir.return %arg1 : !b32i
+p4hir.func @early_return(%arg0 : !p4hir.bool, %arg1 : !b32i) -> !b32i {
+  %0 = p4hir.variable ["val"] : <!b32i>
+  p4hir.assign %arg1, %0 : <!b32i>
+  p4hir.if %arg0 {
+    %c1 = p4hir.const #p4hir.int<1> : !b32i
+    p4hir.assign %c1, %0 : <!b32i>
+    %1 = p4hir.read %0 : <!b32i>
+    p4hir.return %1 : !b32i
+  }
+  %2 = p4hir.read %0 : <!b32i>
+  p4hir.return %2 : !b32i
+}
+
+// Scopes with early returns are kept as-is.
+// CHECK-LABEL: p4hir.func @scope_with_return
+// CHECK: p4hir.scope
+// CHECK: p4hir.return
+p4hir.func @scope_with_return(%arg0 : !b32i) -> !b32i {
+  p4hir.scope {
+    p4hir.return %arg0 : !b32i
+  }
+  p4hir.return %arg0 : !b32i
+}
@@ -0,0 +1,56 @@
+// RUN: p4mlir-opt --p4hir-narrow-bit-width %s | FileCheck %s
+
+!b8i = !p4hir.bit<8>
+!b4i = !p4hir.bit<4>
+!b16i = !p4hir.bit<16>
+!b32i = !p4hir.bit<32>
+!i32i = !p4hir.int<32>
+
+// CHECK-LABEL: p4hir.func @add
+// CHECK: %[[L:.*]] = p4hir.cast(%arg0 : !b8i) : !b9i
+// CHECK: %[[R:.*]] = p4hir.cast(%arg1 : !b8i) : !b9i
+// CHECK: %[[ADD:.*]] = p4hir.binop(add, %[[L]], %[[R]]) : !b9i
+// CHECK: %[[EXT:.*]] = p4hir.cast(%[[ADD]] : !b9i) : !b32i
+// CHECK: p4hir.return %[[EXT]] : !b32i
+p4hir.func @add(%arg0 : !b8i, %arg1 : !b8i) -> !b32i {
+  %0 = p4hir.cast(%arg0 : !b8i) : !b32i
+  %1 = p4hir.cast(%arg1 : !b8i) : !b32i
+  %2 = p4hir.binop(add, %0, %1) : !b32i
+  p4hir.return %2 : !b32i
+}
+
+// Narrowed results feed narrowed users without extra casts
+// CHECK-LABEL: p4hir.func @and_cmp
+// CHECK: %[[AND:.*]] = p4hir.binop(and, %{{.*}}, %{{.*}}) : !b4i
+// CHECK: p4hir.cmp(eq, %[[AND]], %{{.*}}) : !b4i, !p4hir.bool
+p4hir.func @and_cmp(%arg0 : !b32i) -> !p4hir.bool {
+  %c15 = p4hir.const #p4hir.int<15> : !b32i
+  %c3 = p4hir.const #p4hir.int<3> : !b32i
+  %0 = p4hir.binop(and, %arg0, %c15) : !b32i
+  %1 = p4hir.cmp(eq, %0, %c3) : !b32i, !p4hir.bool
+  p4hir.return %1 : !p4hir.bool
+}
+
+// Known zero upper bits of the left operand are dropped
+// CHECK-LABEL: p4hir.func @concat
+// CHECK: %[[L:.*]] = p4hir.binop(and, %{{.*}}, %{{.*}}) : !b1i
+// CHECK: %[[CAT:.*]] = p4hir.concat(%[[L]] : !b1i, %arg1 : !b8i) : !b9i
+// CHECK: p4hir.cast(%[[CAT]] : !b9i) : !b16i
+p4hir.func @concat(%arg0 : !b8i, %arg1 : !b8i) -> !b16i {
+  %c1 = p4hir.const #p4hir.int<1> : !b8i
+  %0 = p4hir.binop(and, %arg0, %c1) : !b8i
+  %1 = p4hir.concat(%0 : !b8i, %arg1 : !b8i) : !b16i
+  p4hir.return %1 : !b16i
+}
+
+// Subtraction and signed arithmetic are left as-is
+// CHECK-LABEL: p4hir.func @no_narrow
+// CHECK: p4hir.binop(sub, %{{.*}}, %{{.*}}) : !b32i
+// CHECK: p4hir.binop(add, %{{.*}}, %{{.*}}) : !i32i
+p4hir.func @no_narrow(%arg0 : !b8i, %arg1 : !i32i) -> !i32i {
+  %0 = p4hir.cast(%arg0 : !b8i) : !b32i
+  %1 = p4hir.binop(sub, %0, %0) : !b32i
+  %2 = p4hir.cast(%1 : !b32i) : !i32i
+  %3 = p4hir.binop(add, %2, %arg1) : !i32i
+  p4hir.return %3 : !i32i
+}
@@ -0,0 +1,82 @@
+// RUN: p4mlir-opt --p4hir-sccp %s | FileCheck %s
+
+!b8i = !p4hir.bit<8>
+
+// Condition is known to be true at all call sites
+// CHECK-LABEL: p4hir.func @configured
+// CHECK-NOT: p4hir.ternary
+// CHECK-NOT: p4hir.if
+// CHECK: p4hir.assign %arg1, %arg2 : <!b8i>
+// CHECK: p4hir.return %arg1 : !b8i
+p4hir.func @configured(%arg0 : !p4hir.bool, %arg1 : !b8i, %arg2 : !p4hir.ref<!b8i>) -> !b8i {
+  %0 = p4hir.ternary(%arg0, true {
+    p4hir.yield %arg1 : !b8i
+  }, false {
+    %c0 = p4hir.const #p4hir.int<0> : !b8i
+    p4hir.yield %c0 : !b8i
+  }) : (!p4hir.bool) -> !b8i
+  p4hir.if %arg0 {
+    p4hir.assign %0, %arg2 : <!b8i>
+  }
+  p4hir.return %0 : !b8i
+}
+
+// CHECK-LABEL: p4hir.func public @caller_const
+// CHECK: p4hir.call @configured
+p4hir.func public @caller_const(%arg0 : !b8i, %arg1 : !p4hir.ref<!b8i>) -> !b8i {
+  %true = p4hir.const #p4hir.bool<true> : !p4hir.bool
+  %0 = p4hir.call @configured(%true, %arg0, %arg1) : (!p4hir.bool, !b8i, !p4hir.ref<!b8i>) -> !b8i
+  p4hir.return %0 : !b8i
+}
+
+// CHECK-LABEL: p4hir.func public @caller_computed
+// CHECK-NOT: p4hir.scope
+// CHECK-NOT: p4hir.cmp
+// CHECK: p4hir.call @configured
+p4hir.func public @caller_computed(%arg0 : !b8i, %arg1 : !p4hir.ref<!b8i>) -> !b8i {
+  %cond = p4hir.scope {
+    %c1 = p4hir.const #p4hir.int<1> : !b8i
+    %c2 = p4hir.const #p4hir.int<2> : !b8i
+    %cmp = p4hir.cmp(lt, %c1, %c2) : !b8i, !p4hir.bool
+    p4hir.yield %cmp : !p4hir.bool
+  } : !p4hir.bool
+  %0 = p4hir.call @configured(%cond, %arg0, %arg1) : (!p4hir.bool, !b8i, !p4hir.ref<!b8i>) -> !b8i
+  p4hir.return %0 : !b8i
+}
+
+// Condition is computed inside another region
+// CHECK-LABEL: p4hir.func public @dead_then
+// CHECK-NOT: p4hir.if
+// CHECK: %[[C:.*]] = p4hir.const #int2_b8i
+// CHECK-NEXT: p4hir.assign %[[C]], %arg0 : <!b8i>
+// CHECK-NEXT: p4hir.return
+p4hir.func public @dead_then(%arg0 : !p4hir.ref<!b8i>) {
+  %c1 = p4hir.const #p4hir.int<1> : !b8i
+  %cond = p4hir.scope {
+    %c2 = p4hir.const #p4hir.int<2> : !b8i
+    %cmp = p4hir.cmp(gt, %c1, %c2) : !b8i, !p4hir.bool
+    p4hir.yield %cmp : !p4hir.bool
+  } : !p4hir.bool
+  p4hir.if %cond {
+    p4hir.assign %c1, %arg0 : <!b8i>
+  } else {
+    %c2 = p4hir.const #p4hir.int<2> : !b8i
+    p4hir.assign %c2, %arg0 : <!b8i>
+  }
+  p4hir.return
+}
+
+// Code after if without else region is still reachable
+// CHECK-LABEL: p4hir.func public @dead_if_without_else
+// CHECK-NOT: p4hir.if
+// CHECK: p4hir.assign %arg1, %arg0 : <!b8i>
+// CHECK-NEXT: p4hir.return
+p4hir.func public @dead_if_without_else(%arg0 : !p4hir.ref<!b8i>, %arg1 : !b8i) {
+  %false = p4hir.const #p4hir.bool<false> : !p4hir.bool
+  p4hir.if %false {
+    %c0 = p4hir.const #p4hir.int<0> : !b8i
+    p4hir.assign %c0, %arg0 : <!b8i>
+  }
+  p4hir.assign %arg1, %arg0 : <!b8i>
+  p4hir.return
+}
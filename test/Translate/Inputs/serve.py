@@ -0,0 +1,59 @@
+"""Starts p4mlir-translate server, sends requests to it and prints responses.
+
+Usage: serve.py <input>... -- <p4mlir-translate> [<option>...]
+
+The socket is created in a fresh temporary directory, as paths of Unix
+sockets are limited to about a hundred characters.
+"""
+
+import os
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+
+
+def request(path, program):
+    with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as conn:
+        conn.connect(path)
+        conn.sendall(program.encode() + b"\n")
+        response = b""
+        while chunk := conn.recv(65536):
+            response += chunk
+    header, _, payload = response.partition(b"\n")
+    status, size = header.decode().split()
+    assert int(size) == len(payload), f"expected {size} bytes, got {len(payload)}"
+    return status, payload.decode()
+
+
+def main():
+    separator = sys.argv.index("--")
+    programs = sys.argv[1:separator]
+    socket_dir = tempfile.mkdtemp()
+    path = os.path.join(socket_dir, "p4mlir.sock")
+    command = sys.argv[separator + 1 :] + ["--serve", path]
+
+    server = subprocess.Popen(command)
+    try:
+        deadline = time.time() + 60
+        while not os.path.exists(path):
+            if server.poll() is not None or time.time() > deadline:
+                sys.exit("server did not start")
+            time.sleep(0.1)
+
+        print(f"MODE: {oct(os.stat(path).st_mode & 0o777)}")
+        for program in programs:
+            status, payload = request(path, program)
+            print(f"STATUS: {status}")
+            print(payload)
+    finally:
+        server.kill()
+        server.wait()
+        if os.path.exists(path):
+            os.remove(path)
+        os.rmdir(socket_dir)
+
+
+if __name__ == "__main__":
+    main()
@@ -1,18 +1,101 @@
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/ToolOutputFile.h"
+#include "mlir/Bytecode/BytecodeWriter.h"
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/InitAllDialects.h"
 #include "mlir/InitAllPasses.h"
+#include "mlir/Pass/PassManager.h"
 #include "mlir/Support/FileUtilities.h"
 #include "mlir/Tools/mlir-opt/MlirOptMain.h"
 
 #include "p4mlir/Dialect/P4HIR/P4HIR_Dialect.h"
+#include "p4mlir/Dialect/P4HIR/P4HIR_LazyLoading.h"
+#include "p4mlir/Transforms/Passes.h"
+
+static llvm::cl::list<std::string> materializeFunctions(
+    "p4hir-materialize",
+    llvm::cl::desc("Lazily load P4HIR bytecode input and run the pipeline "
+                   "only over bodies of the given functions, other bodies "
+                   "are written out unchanged"),
+    llvm::cl::value_desc("function names"), llvm::cl::CommaSeparated);
+
+// Unlike regular MlirOptMain flow, only the requested function bodies are
+// loaded before running the pipeline. The rest are loaded right before
+// writing the output.
+static mlir::LogicalResult runLazily(llvm::StringRef inputFilename,
+                                     llvm::StringRef outputFilename,
+                                     mlir::DialectRegistry &registry) {
+  auto config = mlir::MlirOptMainConfig::createFromCLOptions();
+
+  std::string errorMessage;
+  auto file = mlir::openInputFile(inputFilename, &errorMessage);
+  if (!file) {
+    llvm::errs() << errorMessage << "\n";
+    return mlir::failure();
+  }
+  auto output = mlir::openOutputFile(outputFilename, &errorMessage);
+  if (!output) {
+    llvm::errs() << errorMessage << "\n";
+    return mlir::failure();
+  }
+
+  mlir::MLIRContext context(registry);
+  context.allowUnregisteredDialects(config.shouldAllowUnregisteredDialects());
+
+  auto lazyModule =
+      P4::P4MLIR::P4HIR::LazyModule::open(file->getMemBufferRef(), &context);
+  if (!lazyModule)
+    return mlir::failure();
+
+  for (const auto &name : materializeFunctions)
+    if (failed(lazyModule->materialize(name)))
+      return mlir::failure();
+
+  // Functions that are not loaded look like public declarations and would
+  // fail verification in between passes. The whole module is verified once
+  // it is completely loaded.
+  mlir::PassManager pm(&context, mlir::ModuleOp::getOperationName());
+  pm.enableVerifier(false);
+  if (failed(mlir::applyPassManagerCLOptions(pm)) ||
+      failed(config.setupPassPipeline(pm)) ||
+      failed(pm.run(lazyModule->getModule())))
+    return mlir::failure();
+
+  if (failed(lazyModule->materializeAll()))
+    return mlir::failure();
+  auto module = lazyModule->release();
+
+  if (config.shouldEmitBytecode()) {
+    mlir::BytecodeWriterConfig writerConfig("p4mlir-opt");
+    if (failed(mlir::writeBytecodeToFile(*module, output->os(), writerConfig)))
+      return mlir::failure();
+  } else {
+    module->print(output->os());
+    output->os() << "\n";
+  }
+
+  output->keep();
+  return mlir::success();
+}
 
 int main(int argc, char **argv) {
+  llvm::InitLLVM y(argc, argv);
+
   mlir::registerAllPasses();
+  P4::P4MLIR::registerP4MLIRTransformsPasses();
 
   mlir::DialectRegistry registry;
   registry.insert<P4::P4MLIR::P4HIR::P4HIRDialect,
                   mlir::func::FuncDialect>();
 
+  auto [inputFilename, outputFilename] = mlir::registerAndParseCLIOptions(
+      argc, argv, "P4MLIR optimizer driver\n", registry);
+
+  if (materializeFunctions.empty())
+    return mlir::asMainReturnCode(mlir::MlirOptMain(
+        argc, argv, inputFilename, outputFilename, registry));
+
   return mlir::asMainReturnCode(
-      mlir::MlirOptMain(argc, argv, "P4MLIR optimizer driver\n", registry));
+      runLazily(inputFilename, outputFilename, registry));
 }
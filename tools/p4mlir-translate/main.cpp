@@ -14,6 +14,12 @@ limitations under the License.
 
 #include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "frontends/common/constantFolding.h"
 #include "frontends/common/parseInput.h"
@@ -26,17 +32,37 @@ limitations under the License.
 #include "frontends/p4/validateStringAnnotations.h"
 #include "gc/gc.h"
 #include "ir/ir.h"
+#include "ir/pass_manager.h"
 #include "ir/visitor.h"
 #include "lib/compile_context.h"
 #include "lib/crash.h"
 #include "lib/error.h"
 #include "lib/gc.h"
 #include "options.h"
+#include "serve.h"
+#include "stats.h"
+#include "stream.h"
+#include "subprocess.h"
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/LineIterator.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/TimeProfiler.h"
+#include "llvm/Support/ToolOutputFile.h"
+#include "mlir/Bytecode/BytecodeWriter.h"
+#include "mlir/IR/Diagnostics.h"
 #include "mlir/IR/OperationSupport.h"
+#include "mlir/IR/Verifier.h"
+#include "mlir/Parser/Parser.h"
 #include "mlir/Pass/PassManager.h"
+#include "mlir/Support/FileUtilities.h"
 #include "p4mlir/Dialect/P4HIR/P4HIR_Dialect.h"
 #pragma GCC diagnostic pop
 
@@ -71,34 +97,79 @@ class SetStrictStruct : public P4::Inspector {
     }
 };
 
-}  // namespace
+// Records each of the passes as time trace event. An event is ended when the
+// next pass starts, so events stay balanced even if pass manager stops on error.
+class PassTimeTracer {
+ public:
+    void addPasses(P4::PassManager &passes, std::initializer_list<P4::Visitor *> list) {
+        for (auto *pass : list) {
+            if (!llvm::timeTraceProfilerEnabled()) {
+                passes.addPasses({pass});
+                continue;
+            }
+            passes.addPasses({new P4::VisitFunctor([this, pass]() { begin(pass->name()); }), pass});
+        }
+    }
 
-int main(int argc, char *const argv[]) {
-    setup_gc_logging();
-    P4::setup_signals();
+    void end() {
+        if (active) llvm::timeTraceProfilerEnd();
+        active = false;
+    }
 
-    P4::AutoCompileContext autoP4MLIRTranslateContext(new P4::MLIR::TranslateContext);
-    auto &options = P4::MLIR::TranslateContext::get().options();
-    options.langVersion = P4::CompilerOptions::FrontendVersion::P4_16;
+ private:
+    void begin(const char *name) {
+        end();
+        llvm::timeTraceProfilerBegin(name, "");
+        active = true;
+    }
 
-    if (options.process(argc, argv) == nullptr || P4::errorCount() > 0) return EXIT_FAILURE;
+    bool active = false;
+};
 
-    options.setInputFile();
-    const auto *program = P4::parseP4File(options);
+// Writes time trace on exit, whatever the exit path is
+class TimeTraceWriter {
+ public:
+    explicit TimeTraceWriter(std::string file) : file(std::move(file)) {}
+    ~TimeTraceWriter() {
+        if (!llvm::timeTraceProfilerEnabled()) return;
+        if (auto err = llvm::timeTraceProfilerWrite(file, "p4mlir-translate"))
+            std::cerr << "Failed to write time trace: " << llvm::toString(std::move(err))
+                      << std::endl;
+        llvm::timeTraceProfilerCleanup();
+    }
 
-    if (program == nullptr || P4::errorCount() > 0) return EXIT_FAILURE;
+ private:
+    std::string file;
+};
+
+// Parses the input file given in options and runs the frontend passes.
+// Returns nullptr on error.
+const P4::IR::P4Program *runFrontend(P4::MLIR::TranslateOptions &options, P4::TypeMap &typeMap,
+                                     P4::MLIR::StatsReport *stats) {
+    const P4::IR::P4Program *program = nullptr;
+    {
+        llvm::TimeTraceScope traceScope("Parse");
+        program = P4::parseP4File(options);
+    }
+
+    if (program == nullptr || P4::errorCount() > 0) return nullptr;
+
+    if (stats)
+        stats->addPhase("parse", {{"p4_nodes", P4::MLIR::StatsReport::countNodes(program)}});
 
     log_dump(program, "Parsed program");
     auto hook = options.getDebugHook();
-    P4::TypeMap typeMap;
     if (!options.parseOnly) {
+        llvm::TimeTraceScope traceScope("Frontend");
         if (options.typeinferenceOnly) {
             P4::FrontEndPolicy policy;
 
             P4::ParseAnnotations *parseAnnotations = policy.getParseAnnotations();
             if (!parseAnnotations) parseAnnotations = new P4::ParseAnnotations();
 
-            P4::PassManager passes({
+            P4::PassManager passes;
+            PassTimeTracer passTracer;
+            passTracer.addPasses(passes, {
                 // Parse annotations
                 new P4::ParseAnnotationBodies(parseAnnotations, &typeMap),
                 // Simple checks on parsed program
@@ -121,6 +192,7 @@ int main(int argc, char *const argv[]) {
             passes.setStopOnError(true);
             passes.addDebugHook(hook, true);
             program = program->apply(passes);
+            passTracer.end();
         } else {
             // Apply the front end passes. These are usually fixed.
             P4::FrontEnd fe;
@@ -129,24 +201,487 @@ int main(int argc, char *const argv[]) {
         }
     }
 
-    if (P4::errorCount() > 0) return EXIT_FAILURE;
+    if (P4::errorCount() > 0) return nullptr;
+
+    if (stats && !options.parseOnly)
+        stats->addPhase("frontend", {{"p4_nodes", P4::MLIR::StatsReport::countNodes(program)}});
 
     BUG_CHECK(options.typeinferenceOnly, "TODO: fill TypeMap");
 
     log_dump(program, "After frontend");
+    return program;
+}
+
+P4::P4MLIR::ConversionOptions getConversionOptions(const P4::MLIR::TranslateOptions &options) {
+    P4::P4MLIR::ConversionOptions conversionOptions;
+    conversionOptions.roots = options.roots;
+    conversionOptions.hoistConstants = options.hoistConstants;
+    conversionOptions.parallelBodies = options.threads != 1;
+    if (options.locMode == "line")
+        conversionOptions.locations = P4::P4MLIR::LocationMode::Line;
+    else if (options.locMode == "range")
+        conversionOptions.locations = P4::P4MLIR::LocationMode::Range;
+    return conversionOptions;
+}
+
+// Converts the program to P4HIR. The program and the type map are released
+// once converted. Returns nullptr on error.
+mlir::OwningOpRef<mlir::ModuleOp> convert(mlir::MLIRContext &context,
+                                          const P4::IR::P4Program *&program,
+                                          P4::TypeMap &typeMap,
+                                          const P4::P4MLIR::ConversionOptions &conversionOptions,
+                                          P4::MLIR::StatsReport *stats) {
+    P4::P4MLIR::ConversionStats conversionStats;
+    auto mod = P4::P4MLIR::toMLIR(context, program, &typeMap, conversionOptions, &conversionStats);
+
+    // P4 program is not needed anymore. Only the memory freed explicitly
+    // (e.g. type map entries) could be reused by MLIR: P4 IR nodes are not
+    // reclaimed with GC disabled, see convertInSubprocess.
+    typeMap.clear();
+    program = nullptr;
+    if (!mod) return nullptr;
+
+    if (stats) {
+        auto details = P4::MLIR::StatsReport::moduleStats(*mod);
+        details["converted_values"] = conversionStats.values;
+        details["converted_constants"] = conversionStats.constants;
+        details["converted_types"] = conversionStats.types;
+        details["converted_symbols"] = conversionStats.symbols;
+        stats->addPhase("convert", std::move(details));
+    }
+
+    return mod;
+}
+
+// Verifies the module and writes it to 'os'. Operations already emitted by
+// the streamer are verified and printed by it. Returns false on error.
+bool verifyAndPrint(const P4::MLIR::TranslateOptions &options, mlir::ModuleOp mod,
+                    P4::MLIR::ModuleStreamer *streamer, llvm::raw_ostream &os,
+                    P4::MLIR::StatsReport *stats) {
+    // Streamed operations are verified once converted
+    if (!streamer) {
+        llvm::TimeTraceScope traceScope("Verify");
+        if (failed(mlir::verify(mod))) {
+            // Dump for debugging purposes
+            mod->print(os);
+            mod->emitError("module verification error");
+            return false;
+        }
+
+        if (stats) stats->addPhase("verify");
+    }
+
+    {
+        llvm::TimeTraceScope traceScope("Print");
+        if (streamer) {
+            if (failed(streamer->finish(mod))) return false;
+        } else if (options.emitBytecode) {
+            mlir::BytecodeWriterConfig config("p4mlir-translate");
+            if (failed(mlir::writeBytecodeToFile(mod, os, config))) {
+                mod->emitError("failed to write bytecode");
+                return false;
+            }
+        } else {
+            mlir::OpPrintingFlags flags;
+            mod->print(os, flags.enableDebugInfo(options.printLoc));
+        }
+    }
+
+    if (stats) stats->addPhase("print");
+
+    return true;
+}
+
+// Converts the program to P4HIR, verifies it and writes it to 'os'. The
+// program and the type map are released once converted. Returns false on
+// error.
+bool convertAndPrint(const P4::MLIR::TranslateOptions &options, mlir::MLIRContext &context,
+                     const P4::IR::P4Program *&program, P4::TypeMap &typeMap,
+                     llvm::raw_ostream &os, P4::MLIR::StatsReport *stats) {
+    auto conversionOptions = getConversionOptions(options);
+    std::optional<P4::MLIR::ModuleStreamer> streamer;
+    if (options.stream) {
+        streamer.emplace(os, mlir::OpPrintingFlags());
+        if (!streamer->open()) return false;
+        conversionOptions.streamOp = [&](mlir::Operation *op) { return streamer->emit(op); };
+    }
+
+    auto mod = convert(context, program, typeMap, conversionOptions, stats);
+    if (!mod) return false;
+
+    return verifyAndPrint(options, *mod, streamer ? &*streamer : nullptr, os, stats);
+}
+
+// Enables threading of the context created with threading disabled. The
+// pool is only created when more than one thread is requested and should
+// outlive the context. Otherwise the context uses its own default pool
+// (e.g. for verification), while P4 conversion stays serial. Threads do not
+// survive fork(), so this is done by the process the program is converted in.
+void enableThreading(const P4::MLIR::TranslateOptions &options, mlir::MLIRContext &context,
+                     std::optional<llvm::DefaultThreadPool> &threadPool) {
+    if (options.threads != 1) {
+        threadPool.emplace(llvm::hardware_concurrency(options.threads));
+        context.setThreadPool(*threadPool);
+    } else {
+        context.enableMultithreading();
+    }
+}
+
+// Creates the context with threading disabled and P4HIR dialect loaded, so
+// it could be shared with forked processes
+std::unique_ptr<mlir::MLIRContext> createSharedContext() {
+    auto context = std::make_unique<mlir::MLIRContext>(mlir::MLIRContext::Threading::DISABLED);
+    context->getOrLoadDialect<P4::P4MLIR::P4HIR::P4HIRDialect>();
+    return context;
+}
+
+// Creates the context the P4 program is converted in
+std::unique_ptr<mlir::MLIRContext> createContext(
+    const P4::MLIR::TranslateOptions &options,
+    std::optional<llvm::DefaultThreadPool> &threadPool) {
+    auto context = createSharedContext();
+    enableThreading(options, *context, threadPool);
+    return context;
+}
+
+// Runs the frontend and converts the program in a separate process, which
+// returns the (not yet verified) module as bytecode. The memory of P4 IR
+// could not be reclaimed by GC once MLIR is used, so this way it is
+// returned to the system before the module is verified and printed. Note
+// the bytecode is buffered by the parent while the child still holds both
+// IRs, so whether the peak memory usage of the host goes down depends on
+// the input. Statistics of the process go first, prefixed by their size.
+std::optional<std::string> convertInSubprocess(P4::MLIR::TranslateOptions &options,
+                                               P4::MLIR::StatsReport *stats) {
+    auto output = P4::MLIR::runInSubprocess([&](int fd) {
+        P4::TypeMap typeMap;
+        const auto *program = runFrontend(options, typeMap, stats);
+        if (program == nullptr) return false;
+
+        // See main() for the details
+        GC_gcollect();
+        GC_disable();
+
+        std::optional<llvm::DefaultThreadPool> threadPool;
+        auto context = createContext(options, threadPool);
+        auto mod = convert(*context, program, typeMap, getConversionOptions(options), stats);
+        if (!mod || P4::errorCount() > 0) return false;
+
+        std::string report;
+        if (stats) {
+            llvm::raw_string_ostream reportStream(report);
+            stats->print(reportStream);
+        }
+
+        llvm::raw_fd_ostream os(fd, /*shouldClose=*/false);
+        os << report.size() << "\n" << report;
+        mlir::BytecodeWriterConfig config("p4mlir-translate");
+        if (failed(mlir::writeBytecodeToFile(*mod, os, config))) {
+            mod->emitError("failed to write bytecode");
+            return false;
+        }
+        os.flush();
+        return !os.has_error();
+    });
+    if (!output) return std::nullopt;
+
+    llvm::StringRef data(*output);
+    auto [header, rest] = data.split('\n');
+    size_t reportSize;
+    if (header.getAsInteger(10, reportSize) || reportSize > rest.size() ||
+        (stats && !stats->addPhases(rest.take_front(reportSize)))) {
+        P4::error("Malformed output of conversion process");
+        return std::nullopt;
+    }
+    output->erase(0, header.size() + 1 + reportSize);
+    return output;
+}
+
+// Reads the module written by convertInSubprocess. It is verified later, as
+// usual. Returns nullptr on error.
+mlir::OwningOpRef<mlir::ModuleOp> loadModule(mlir::MLIRContext &context,
+                                             const std::string &bytecode,
+                                             P4::MLIR::StatsReport *stats) {
+    llvm::TimeTraceScope traceScope("Load");
+    mlir::ParserConfig config(&context, /*verifyAfterParse=*/false);
+    auto mod = mlir::parseSourceString<mlir::ModuleOp>(bytecode, config);
+    if (!mod) return nullptr;
+
+    if (stats) stats->addPhase("load");
+    return mod;
+}
+
+struct BatchEntry {
+    std::string input;
+    std::string output;
+};
+
+// Reads the batch manifest: each line names an input file and, optionally,
+// the output file. By default the output is written next to the input with
+// the extension replaced. Empty lines and lines starting with '#' are
+// skipped.
+std::optional<std::vector<BatchEntry>> readManifest(const P4::MLIR::TranslateOptions &options) {
+    auto buffer = llvm::MemoryBuffer::getFile(options.batchManifest);
+    if (!buffer) {
+        P4::error("Failed to read batch manifest %1%: %2%", options.batchManifest,
+                  buffer.getError().message());
+        return std::nullopt;
+    }
+
+    std::vector<BatchEntry> entries;
+    for (llvm::line_iterator line(**buffer, /*SkipBlanks=*/true, '#'); !line.is_at_end();
+         ++line) {
+        llvm::SmallVector<llvm::StringRef, 2> fields;
+        llvm::SplitString(*line, fields);
+        if (fields.empty()) continue;
+        if (fields.size() > 2) {
+            P4::error("%1%:%2%: expected '<input> [<output>]'", options.batchManifest,
+                      line.line_number());
+            return std::nullopt;
+        }
+
+        BatchEntry entry{fields[0].str(), {}};
+        if (fields.size() == 2) {
+            entry.output = fields[1].str();
+        } else {
+            llvm::SmallString<128> output(entry.input);
+            llvm::sys::path::replace_extension(output, options.emitBytecode ? "mlirbc" : "mlir");
+            entry.output = output.str().str();
+        }
+        entries.push_back(std::move(entry));
+    }
 
-    // MLIR uses thread local storage which is not registered by GC causing
-    // double frees
+    return entries;
+}
+
+// Translates a single input of the batch into its output file. Threading of
+// the context is enabled unless already done. Returns false on error.
+bool translateEntry(P4::MLIR::TranslateOptions &options, mlir::MLIRContext &context,
+                    const BatchEntry &entry, P4::MLIR::StatsReport *stats) {
+    P4::AutoCompileContext inputContext(new P4::MLIR::TranslateContext(options));
+    auto &inputOptions = P4::MLIR::TranslateContext::get().options();
+    inputOptions.file = entry.input;
+
+    std::string errorMessage;
+    auto output = mlir::openOutputFile(entry.output, &errorMessage);
+    if (!output) {
+        std::cerr << errorMessage << std::endl;
+        return false;
+    }
+
+    P4::TypeMap typeMap;
+    const auto *program = runFrontend(inputOptions, typeMap, stats);
+    if (program == nullptr) return false;
+
+    // See main() for the details
+    GC_gcollect();
     GC_disable();
 
-    mlir::MLIRContext context;
-    context.getOrLoadDialect<P4::P4MLIR::P4HIR::P4HIRDialect>();
+    std::optional<llvm::DefaultThreadPool> threadPool;
+    if (!context.isMultithreadingEnabled()) enableThreading(inputOptions, context, threadPool);
+    if (!convertAndPrint(inputOptions, context, program, typeMap, output->os(), stats) ||
+        P4::errorCount() > 0)
+        return false;
+
+    output->keep();
+    return true;
+}
+
+// Translates all the inputs from the batch manifest. Each input is
+// translated in its own process, at most --batch-jobs of them at once, so GC
+// could run during its frontend and all its memory is released once it is
+// done. The processes are forked from this one after P4HIR dialect is loaded
+// into the shared context, so it is only done once. When time traced, inputs
+// are translated one by one in this process instead, as the trace is
+// recorded per process, and the memory of previous inputs is not reclaimed.
+// Each input gets its own compile context, so diagnostics and error counts
+// are per input. Statistics and failures are reported in manifest order.
+int runBatch(P4::MLIR::TranslateOptions &options) {
+    auto entries = readManifest(options);
+    if (!entries) return EXIT_FAILURE;
+
+    const bool inProcess = llvm::timeTraceProfilerEnabled();
+    if (inProcess) GC_disable();
+
+    std::optional<P4::MLIR::StatsReport> stats;
+    if (options.stats) stats.emplace();
+
+    // Threading is enabled by the processes translating the inputs, as
+    // threads do not survive fork()
+    std::optional<llvm::DefaultThreadPool> threadPool;
+    auto context = createSharedContext();
+    if (inProcess) enableThreading(options, *context, threadPool);
+
+    std::vector<bool> succeeded(entries->size());
+    if (inProcess) {
+        for (size_t i = 0; i < entries->size(); ++i) {
+            const auto &entry = (*entries)[i];
+            llvm::TimeTraceScope traceScope("Translate", entry.input);
+            if (stats) stats->setInput(entry.input);
+            succeeded[i] = translateEntry(options, *context, entry, stats ? &*stats : nullptr);
+        }
+    } else {
+        auto reports = P4::MLIR::runInSubprocesses(
+            entries->size(), llvm::hardware_concurrency(options.batchJobs).compute_thread_count(),
+            [&](size_t i, int fd) {
+                const auto &entry = (*entries)[i];
+                std::optional<P4::MLIR::StatsReport> inputStats;
+                if (stats) {
+                    inputStats.emplace();
+                    inputStats->setInput(entry.input);
+                }
+                if (!translateEntry(options, *context, entry,
+                                    inputStats ? &*inputStats : nullptr))
+                    return false;
+
+                if (inputStats) {
+                    llvm::raw_fd_ostream os(fd, /*shouldClose=*/false);
+                    inputStats->print(os);
+                }
+                return true;
+            });
+        for (size_t i = 0; i < entries->size(); ++i)
+            succeeded[i] = reports[i] && (!stats || stats->addPhases(*reports[i]));
+    }
+
+    size_t failures = 0;
+    for (size_t i = 0; i < entries->size(); ++i) {
+        if (succeeded[i]) continue;
+        std::cerr << (*entries)[i].input << ": translation failed" << std::endl;
+        ++failures;
+    }
+
+    if (stats) stats->print(llvm::errs());
+
+    if (failures > 0) {
+        std::cerr << failures << " of " << entries->size() << " inputs failed to translate"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+// Serves translation requests until killed. Each request is handled in a
+// forked process with its own compile context and diagnostics captured into
+// the response.
+int runServer(P4::MLIR::TranslateOptions &options, mlir::MLIRContext &context) {
+    P4::MLIR::TranslateServer server(
+        options.serveSocket, llvm::hardware_concurrency(options.serveJobs).compute_thread_count());
+    if (!server.open()) return EXIT_FAILURE;
+
+    auto handler = [&](const std::string &input) -> P4::MLIR::TranslateServer::Response {
+        std::optional<llvm::DefaultThreadPool> threadPool;
+        enableThreading(options, context, threadPool);
 
-    auto mod = P4::P4MLIR::toMLIR(context, program, &typeMap);
-    if (!mod) return EXIT_FAILURE;
+        P4::AutoCompileContext inputContext(new P4::MLIR::TranslateContext(options));
+        auto &inputOptions = P4::MLIR::TranslateContext::get().options();
+        inputOptions.file = input;
+
+        std::stringstream diagnostics;
+        P4::BaseCompileContext::get().errorReporter().setOutputStream(&diagnostics);
+        std::string mlirDiagnostics;
+        llvm::raw_string_ostream mlirDiagnosticsStream(mlirDiagnostics);
+        llvm::SourceMgr sourceMgr;
+        mlir::SourceMgrDiagnosticHandler diagHandler(sourceMgr, &context, mlirDiagnosticsStream);
+
+        std::string result;
+        llvm::raw_string_ostream resultStream(result);
+        P4::TypeMap typeMap;
+        const auto *program = runFrontend(inputOptions, typeMap, nullptr);
+        if (program != nullptr &&
+            convertAndPrint(inputOptions, context, program, typeMap, resultStream, nullptr) &&
+            P4::errorCount() == 0)
+            return {true, std::move(result)};
+        return {false, diagnostics.str() + mlirDiagnostics};
+    };
+
+    return server.serve(handler) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+}  // namespace
+
+int main(int argc, char *const argv[]) {
+    setup_gc_logging();
+    P4::setup_signals();
+
+    P4::AutoCompileContext autoP4MLIRTranslateContext(new P4::MLIR::TranslateContext);
+    auto &options = P4::MLIR::TranslateContext::get().options();
+    options.langVersion = P4::CompilerOptions::FrontendVersion::P4_16;
+
+    if (options.process(argc, argv) == nullptr || P4::errorCount() > 0) return EXIT_FAILURE;
+
+    // Bytecode and location aliases are both written after everything is
+    // known, which defeats streaming. Statistics describe the complete
+    // module, while the streamed one has bodies dropped.
+    if (options.stream && (options.emitBytecode || options.printLoc || options.stats)) {
+        P4::error("--stream could not be combined with --emit-bytecode, --print-loc or --stats");
+        return EXIT_FAILURE;
+    }
+    // Streamed module is printed while being converted
+    if (options.stream && options.isolateFrontend) {
+        P4::error("--stream could not be combined with --isolate-frontend");
+        return EXIT_FAILURE;
+    }
+
+    if (!options.timeTraceFile.empty())
+        llvm::timeTraceProfilerInitialize(options.timeTraceGranularity, argv[0]);
+    TimeTraceWriter timeTraceWriter(options.timeTraceFile);
+
+    const bool batch = !options.batchManifest.empty();
+    const bool serve = !options.serveSocket.empty();
+    if (batch && serve) {
+        P4::error("--batch could not be combined with --serve");
+        return EXIT_FAILURE;
+    }
+    if (batch) return runBatch(options);
+
+    std::optional<P4::MLIR::StatsReport> stats;
+    P4::TypeMap typeMap;
+    const P4::IR::P4Program *program = nullptr;
+    std::optional<std::string> converted;
+    if (!serve) {
+        options.setInputFile();
+        if (options.stats) stats.emplace();
+        // Time trace events are recorded per process, so tracing keeps
+        // everything in-process
+        if (options.isolateFrontend && !llvm::timeTraceProfilerEnabled()) {
+            converted = convertInSubprocess(options, stats ? &*stats : nullptr);
+            if (!converted) return EXIT_FAILURE;
+        } else {
+            program = runFrontend(options, typeMap, stats ? &*stats : nullptr);
+            if (program == nullptr) return EXIT_FAILURE;
+
+            // MLIR uses thread local storage which is not registered by GC
+            // causing double frees. Collect the garbage left by the frontend
+            // passes while we still can, so MLIR starts with a compact heap.
+            GC_gcollect();
+        }
+    }
+    // Server requests are handled in separate processes, which free
+    // everything on exit
+    GC_disable();
+
+    if (serve) {
+        // Threading is enabled for each request instead
+        auto context = createSharedContext();
+        return runServer(options, *context);
+    }
+
+    std::optional<llvm::DefaultThreadPool> threadPool;
+    auto context = createContext(options, threadPool);
+
+    if (converted) {
+        auto mod = loadModule(*context, *converted, stats ? &*stats : nullptr);
+        converted.reset();
+        if (!mod ||
+            !verifyAndPrint(options, *mod, nullptr, llvm::outs(), stats ? &*stats : nullptr))
+            return EXIT_FAILURE;
+    } else if (!convertAndPrint(options, *context, program, typeMap, llvm::outs(),
+                                stats ? &*stats : nullptr)) {
+        return EXIT_FAILURE;
+    }
 
-    mlir::OpPrintingFlags flags;
-    mod->print(llvm::outs(), flags.enableDebugInfo(options.printLoc));
+    if (stats) stats->print(llvm::errs());
 
     if (P4::Log::verbose()) std::cerr << "Done." << std::endl;
     return P4::errorCount() > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
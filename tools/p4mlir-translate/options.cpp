@@ -14,8 +14,24 @@ limitations under the License.
 
 #include "options.h"
 
+#include <climits>
+#include <cstdlib>
+#include <string_view>
+
+#include "lib/error.h"
+
 using namespace P4::MLIR;
 
+namespace {
+bool parseUnsigned(const char *arg, unsigned &value) {
+    char *end = nullptr;
+    auto parsed = std::strtoul(arg, &end, 10);
+    if (*arg == '\0' || *end != '\0' || parsed > UINT_MAX) return false;
+    value = parsed;
+    return true;
+}
+}  // namespace
+
 TranslateOptions::TranslateOptions() {
     registerOption(
         "--parse-only", nullptr,
@@ -38,4 +54,130 @@ TranslateOptions::TranslateOptions() {
             return true;
         },
         "print location information in MLIR dump");
+    registerOption(
+        "--loc-mode", "full|line|range",
+        [this](const char *arg) {
+            std::string_view mode(arg);
+            if (mode != "full" && mode != "line" && mode != "range") {
+                ::P4::error("Invalid location mode: %1%", arg);
+                return false;
+            }
+            locMode = mode;
+            return true;
+        },
+        "source locations to attach to operations: file, line and column of the node start "
+        "(full, default), file and line only (line) or start and end fused together (range)");
+    registerOption(
+        "--hoist-constants", nullptr,
+        [this](const char *) {
+            hoistConstants = true;
+            return true;
+        },
+        "emit each distinct constant once per function or action at its entry");
+    registerOption(
+        "--emit-bytecode", nullptr,
+        [this](const char *) {
+            emitBytecode = true;
+            return true;
+        },
+        "write MLIR bytecode (always including locations) instead of textual IR");
+    registerOption(
+        "--stream", nullptr,
+        [this](const char *) {
+            stream = true;
+            return true;
+        },
+        "verify and print each function as soon as it is converted to reduce memory usage");
+    registerOption(
+        "--isolate-frontend", nullptr,
+        [this](const char *) {
+            isolateFrontend = true;
+            return true;
+        },
+        "run the frontend and conversion in a separate process, which passes the module back "
+        "as bytecode, so the memory of P4 IR is freed before the module is printed");
+    registerOption(
+        "--batch", "manifest",
+        [this](const char *arg) {
+            batchManifest = arg;
+            return true;
+        },
+        "translate each input listed in the manifest ('<input> [<output>]' per line)");
+    registerOption(
+        "--batch-jobs", "N",
+        [this](const char *arg) {
+            if (!parseUnsigned(arg, batchJobs)) {
+                ::P4::error("Invalid number of jobs: %1%", arg);
+                return false;
+            }
+            return true;
+        },
+        "translate at most N batch inputs at once (0 means all cores, default is 0)");
+    registerOption(
+        "--serve", "socket",
+        [this](const char *arg) {
+            serveSocket = arg;
+            return true;
+        },
+        "serve translation requests on the Unix socket instead of translating an input file");
+    registerOption(
+        "--serve-jobs", "N",
+        [this](const char *arg) {
+            if (!parseUnsigned(arg, serveJobs)) {
+                ::P4::error("Invalid number of jobs: %1%", arg);
+                return false;
+            }
+            return true;
+        },
+        "handle at most N server requests at once (0 means all cores, default is 0)");
+    registerOption(
+        "--threads", "N",
+        [this](const char *arg) {
+            if (!parseUnsigned(arg, threads)) {
+                ::P4::error("Invalid number of threads: %1%", arg);
+                return false;
+            }
+            return true;
+        },
+        "convert function and action bodies in parallel using N threads (0 means all cores, "
+        "default is 1)");
+    registerOption(
+        "--roots", "NAME[,NAME...]",
+        [this](const char *arg) {
+            std::string_view names(arg);
+            while (!names.empty()) {
+                auto pos = names.find(',');
+                auto name = names.substr(0, pos);
+                if (!name.empty()) roots.emplace_back(name);
+                if (pos == std::string_view::npos) break;
+                names.remove_prefix(pos + 1);
+            }
+            return true;
+        },
+        "translate only the given top-level declarations (e.g. controls, actions or main "
+        "package) and declarations they reference");
+    registerOption(
+        "--time-trace", "FILE",
+        [this](const char *arg) {
+            timeTraceFile = arg;
+            return true;
+        },
+        "write Chrome trace of parsing, frontend passes and conversion to FILE");
+    registerOption(
+        "--time-trace-granularity", "N",
+        [this](const char *arg) {
+            if (!parseUnsigned(arg, timeTraceGranularity)) {
+                ::P4::error("Invalid time trace granularity: %1%", arg);
+                return false;
+            }
+            return true;
+        },
+        "minimum duration of events recorded in time trace, in microseconds (default is 500)");
+    registerOption(
+        "--stats", nullptr,
+        [this](const char *) {
+            stats = true;
+            return true;
+        },
+        "print peak memory usage and IR sizes after each translation phase as JSON to stderr");
 }
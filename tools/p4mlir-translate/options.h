@@ -15,6 +15,9 @@ limitations under the License.
 #ifndef _P4MLIR_OPTIONS_H_
 #define _P4MLIR_OPTIONS_H_
 
+#include <string>
+#include <vector>
+
 #include "frontends/common/options.h"
 #include "frontends/common/parser_options.h"
 
@@ -25,6 +28,38 @@ class TranslateOptions : public CompilerOptions {
     bool parseOnly = false;
     bool typeinferenceOnly = false;
     bool printLoc = false;
+    // How source locations are represented: "full", "line" or "range"
+    std::string locMode = "full";
+    bool hoistConstants = false;
+    // Write MLIR bytecode instead of textual IR
+    bool emitBytecode = false;
+    // Verify and print each top-level operation as soon as it is converted
+    bool stream = false;
+    // Run the frontend and conversion in a separate process, so the memory
+    // of P4 IR is returned to the system before the module is printed
+    bool isolateFrontend = false;
+    // File listing inputs (and optionally outputs) to translate in a single
+    // process, batch mode is disabled if empty
+    std::string batchManifest;
+    // Maximum number of batch inputs translated at once, 0 means the number
+    // of available cores
+    unsigned batchJobs = 0;
+    // Unix socket to serve translation requests on, server mode is disabled
+    // if empty
+    std::string serveSocket;
+    // Maximum number of requests handled by the server at once, 0 means the
+    // number of available cores
+    unsigned serveJobs = 0;
+    // Number of threads used for conversion, 0 means all available cores
+    unsigned threads = 1;
+    // Names of top-level declarations to start translation from, everything
+    // is translated if empty
+    std::vector<std::string> roots;
+    // Chrome trace output file, time tracing is disabled if empty
+    std::string timeTraceFile;
+    unsigned timeTraceGranularity = 500;
+    // Print memory and IR size statistics as JSON to stderr
+    bool stats = false;
 
     virtual ~TranslateOptions() = default;
 
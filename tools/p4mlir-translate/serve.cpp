@@ -0,0 +1,198 @@
+/*
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "serve.h"
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "lib/error.h"
+
+namespace P4::MLIR {
+
+namespace {
+
+bool writeAll(int fd, const std::string &data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        auto n = ::send(fd, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        written += n;
+    }
+    return true;
+}
+
+// Reads the request line, without the line terminator. Returns false if the
+// request is too long or the connection has failed (e.g. timed out).
+bool readRequest(int fd, std::string &request) {
+    char buffer[4096];
+    while (request.find('\n') == std::string::npos) {
+        if (request.size() > TranslateServer::kMaxRequestSize) return false;
+        auto n = ::read(fd, buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) return false;
+        if (n == 0) break;
+        request.append(buffer, n);
+    }
+    request.resize(std::min(request.find('\n'), request.size()));
+    if (!request.empty() && request.back() == '\r') request.pop_back();
+    return request.size() <= TranslateServer::kMaxRequestSize;
+}
+
+// Number of request handlers that are not reaped yet
+volatile sig_atomic_t runningHandlers = 0;
+
+// Reaps finished request handlers. SIGCHLD is not simply ignored, as the
+// disposition would be inherited by the handlers, which then could not wait
+// for their own children (e.g. the preprocessor run via popen()).
+void reapChildren(int) {
+    int savedErrno = errno;
+    while (::waitpid(-1, nullptr, WNOHANG) > 0) --runningHandlers;
+    errno = savedErrno;
+}
+
+}  // namespace
+
+TranslateServer::~TranslateServer() {
+    if (listenFd < 0) return;
+    ::close(listenFd);
+    ::unlink(socketPath.c_str());
+}
+
+bool TranslateServer::open() {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(addr.sun_path)) {
+        ::P4::error("Socket path is too long: %1%", socketPath);
+        return false;
+    }
+    std::memcpy(addr.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    // Only a socket could be replaced, not an arbitrary file
+    struct stat st;
+    if (::stat(socketPath.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            ::P4::error("%1% exists and is not a socket", socketPath);
+            return false;
+        }
+        ::unlink(socketPath.c_str());
+    }
+
+    listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        ::P4::error("Failed to create socket: %1%", std::strerror(errno));
+        return false;
+    }
+    // Requests name files to read, so only the owner is allowed to connect.
+    // The socket is created with these permissions right away rather than
+    // chmod()-ed after bind(), so there is no window for others to connect.
+    mode_t oldMask = ::umask(S_IRWXG | S_IRWXO | S_IXUSR);
+    int bound = ::bind(listenFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+    ::umask(oldMask);
+    if (bound < 0 || ::listen(listenFd, SOMAXCONN) < 0) {
+        ::P4::error("Failed to listen on %1%: %2%", socketPath, std::strerror(errno));
+        ::close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+
+    return true;
+}
+
+bool TranslateServer::serve(const Handler &handler) {
+    // Request handlers are never waited for, they are reaped once finished
+    struct sigaction action {};
+    action.sa_handler = reapChildren;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+    if (::sigaction(SIGCHLD, &action, nullptr) < 0) {
+        ::P4::error("Failed to set SIGCHLD handler: %1%", std::strerror(errno));
+        return false;
+    }
+
+    sigset_t childMask, oldMask;
+    sigemptyset(&childMask);
+    sigaddset(&childMask, SIGCHLD);
+
+    while (true) {
+        // Wait for a handler to finish if there are too many of them. SIGCHLD
+        // is blocked while the counter is checked or updated, so it is neither
+        // missed nor interrupts the update.
+        ::sigprocmask(SIG_BLOCK, &childMask, &oldMask);
+        while (runningHandlers >= static_cast<sig_atomic_t>(maxHandlers)) ::sigsuspend(&oldMask);
+        ::sigprocmask(SIG_SETMASK, &oldMask, nullptr);
+
+        int fd = ::accept(listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            ::P4::error("Failed to accept connection on %1%: %2%", socketPath,
+                        std::strerror(errno));
+            return false;
+        }
+
+        // Clients that do not send the request in time do not hold a handler
+        timeval timeout{kReceiveTimeout, 0};
+        ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+        ::sigprocmask(SIG_BLOCK, &childMask, &oldMask);
+        auto pid = ::fork();
+        if (pid > 0) ++runningHandlers;
+        if (pid == 0) {
+            std::signal(SIGCHLD, SIG_DFL);
+            ::sigprocmask(SIG_SETMASK, &oldMask, nullptr);
+            ::close(listenFd);
+            handleConnection(fd, handler);
+            ::close(fd);
+            // Skip destructors of the server state shared with the parent
+            std::cout.flush();
+            std::cerr.flush();
+            ::_exit(EXIT_SUCCESS);
+        }
+
+        ::sigprocmask(SIG_SETMASK, &oldMask, nullptr);
+
+        // The request is not handled, but the server could proceed with the
+        // next ones
+        if (pid < 0) std::cerr << "Failed to fork: " << std::strerror(errno) << std::endl;
+        ::close(fd);
+    }
+}
+
+void TranslateServer::handleConnection(int fd, const Handler &handler) {
+    std::string input;
+    Response response;
+    if (!readRequest(fd, input))
+        response = {false, "request is too long or was not received in time\n"};
+    else if (input.empty())
+        response = {false, "expected path of P4 program to translate\n"};
+    else
+        response = handler(input);
+    std::string header = (response.success ? "ok " : "error ") +
+                         std::to_string(response.payload.size()) + "\n";
+    if (writeAll(fd, header)) writeAll(fd, response.payload);
+}
+
+}  // namespace P4::MLIR
@@ -0,0 +1,81 @@
+/*
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _P4MLIR_SERVE_H_
+#define _P4MLIR_SERVE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <utility>
+
+namespace P4::MLIR {
+
+// Serves translation requests on a Unix domain socket. Each connection
+// carries a single request: a line with the path of the P4 program to
+// translate. The response is a header line, "ok <size>" or "error <size>",
+// followed by <size> bytes of the translated module or of the diagnostics,
+// after which the connection is closed.
+//
+// Each request is handled in a process forked from the server, so it starts
+// with everything the server has already initialized, while the memory of
+// the P4 frontend is reclaimed once the request is done and a crash while
+// translating does not take the server down. Only P4C and MLIR initialization
+// (including P4HIR dialect registration) is saved this way. Parsed and type
+// checked standard includes (core.p4, architecture files) are not cached:
+// P4C preprocesses, parses and type checks each program as a whole, and its
+// frontend could not start from an already checked prefix of declarations.
+//
+// The socket is only accessible by its owner. Requests longer than
+// kMaxRequestSize or not received within kReceiveTimeout are rejected.
+class TranslateServer {
+ public:
+    // Request is a file path, so it could not be longer than that
+    static constexpr size_t kMaxRequestSize = 4096;
+    static constexpr int kReceiveTimeout = 30;  // seconds
+
+    struct Response {
+        bool success;
+        std::string payload;
+    };
+    // Translates the program at the given path
+    using Handler = std::function<Response(const std::string &input)>;
+
+    // At most 'maxHandlers' requests are handled at once, further connections
+    // wait to be accepted
+    TranslateServer(std::string socketPath, unsigned maxHandlers)
+        : socketPath(std::move(socketPath)), maxHandlers(std::max(maxHandlers, 1u)) {}
+    ~TranslateServer();
+
+    // Creates the socket and starts listening on it. A stale socket left by
+    // a previous server is replaced. Returns false and reports an error on
+    // failure.
+    bool open();
+
+    // Handles requests until the server is killed. Returns false and reports
+    // an error if connections could not be accepted anymore.
+    bool serve(const Handler &handler);
+
+ private:
+    void handleConnection(int fd, const Handler &handler);
+
+    std::string socketPath;
+    unsigned maxHandlers;
+    int listenFd = -1;
+};
+
+}  // namespace P4::MLIR
+
+#endif /* _P4MLIR_SERVE_H_ */
@@ -0,0 +1,123 @@
+/*
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stats.h"
+
+#include <sys/resource.h>
+
+#include "ir/visitor.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "mlir/IR/AttrTypeSubElements.h"
+#include "mlir/IR/Location.h"
+#include "mlir/IR/Operation.h"
+#pragma GCC diagnostic pop
+
+using namespace P4::MLIR;
+
+namespace {
+
+// Peak resident set size of the process in kilobytes
+long peakRSS() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+#ifdef __APPLE__
+    // macOS reports bytes
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+class NodeCounter : public P4::Inspector {
+ public:
+    bool preorder(const P4::IR::Node *) override {
+        ++count;
+        return true;
+    }
+
+    size_t count = 0;
+};
+
+}  // namespace
+
+void StatsReport::addPhase(llvm::StringRef name, llvm::json::Object details) {
+    details["phase"] = name.str();
+    if (!input.empty()) details["input"] = input;
+    details["peak_rss_kb"] = peakRSS();
+    phases.push_back(std::move(details));
+}
+
+void StatsReport::print(llvm::raw_ostream &os) const {
+    os << llvm::formatv("{0:2}", llvm::json::Value(llvm::json::Object{{"phases", phases}}))
+       << "\n";
+}
+
+bool StatsReport::addPhases(llvm::StringRef report) {
+    auto value = llvm::json::parse(report);
+    if (!value) {
+        llvm::consumeError(value.takeError());
+        return false;
+    }
+
+    const auto *object = value->getAsObject();
+    const auto *reported = object ? object->getArray("phases") : nullptr;
+    if (!reported) return false;
+    for (const auto &phase : *reported) phases.push_back(phase);
+    return true;
+}
+
+size_t StatsReport::countNodes(const P4::IR::Node *program) {
+    NodeCounter counter;
+    program->apply(counter);
+    return counter.count;
+}
+
+llvm::json::Object StatsReport::moduleStats(mlir::ModuleOp module) {
+    llvm::StringMap<size_t> opCounts;
+    llvm::DenseSet<mlir::Type> types;
+    llvm::DenseSet<mlir::Attribute> attrs;
+
+    // Walk nested types and attributes as well, e.g. field types of
+    // aggregates or types of typed attributes
+    mlir::AttrTypeWalker walker;
+    walker.addWalk([&](mlir::Type type) { types.insert(type); });
+    walker.addWalk([&](mlir::Attribute attr) { attrs.insert(attr); });
+
+    module->walk([&](mlir::Operation *op) {
+        ++opCounts[op->getName().getStringRef()];
+        walker.walk(op->getAttrDictionary());
+        walker.walk(mlir::LocationAttr(op->getLoc()));
+        for (auto type : op->getResultTypes()) walker.walk(type);
+        for (auto &region : op->getRegions())
+            for (auto &block : region)
+                for (auto type : block.getArgumentTypes()) walker.walk(type);
+    });
+
+    llvm::json::Object ops;
+    size_t numOps = 0;
+    for (const auto &entry : opCounts) {
+        ops[entry.getKey().str()] = entry.getValue();
+        numOps += entry.getValue();
+    }
+
+    return llvm::json::Object{{"mlir_ops", numOps},
+                              {"mlir_ops_by_name", std::move(ops)},
+                              {"mlir_unique_types", types.size()},
+                              {"mlir_unique_attributes", attrs.size()}};
+}
@@ -0,0 +1,65 @@
+/*
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _P4MLIR_STATS_H_
+#define _P4MLIR_STATS_H_
+
+#include <cstddef>
+#include <string>
+
+#include "ir/node.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/IR/BuiltinOps.h"
+#pragma GCC diagnostic pop
+
+namespace P4::MLIR {
+
+// Collects memory and IR size statistics of translation phases and prints
+// them as JSON
+class StatsReport {
+ public:
+    // Adds a phase that just finished. Peak memory usage so far is recorded
+    // together with the given details.
+    void addPhase(llvm::StringRef name, llvm::json::Object details = {});
+
+    // Phases added afterwards are attributed to the given input file, e.g.
+    // in batch mode
+    void setInput(llvm::StringRef name) { input = name.str(); }
+
+    void print(llvm::raw_ostream &os) const;
+
+    // Adds the phases of a report printed by another process (e.g. the one
+    // running the frontend). Returns false if the report could not be parsed.
+    bool addPhases(llvm::StringRef report);
+
+    // Number of unique nodes in the P4 program
+    static size_t countNodes(const P4::IR::Node *program);
+
+    // Number of operations per operation name and the number of unique types
+    // and attributes used in the module
+    static llvm::json::Object moduleStats(mlir::ModuleOp module);
+
+ private:
+    llvm::json::Array phases;
+    std::string input;
+};
+
+}  // namespace P4::MLIR
+
+#endif /* _P4MLIR_STATS_H_ */
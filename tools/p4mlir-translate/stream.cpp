@@ -0,0 +1,153 @@
+/*
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stream.h"
+
+#include "lib/error.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/IR/Verifier.h"
+#pragma GCC diagnostic pop
+
+namespace P4::MLIR {
+
+namespace {
+
+std::string printToString(mlir::Operation *op, const mlir::OpPrintingFlags &flags) {
+    std::string text;
+    llvm::raw_string_ostream os(text);
+    op->print(os, flags);
+    return text;
+}
+
+// Printed top-level operation starts with alias definitions followed by the
+// operation itself. Returns the offset of the latter.
+size_t skipAliases(llvm::StringRef text) {
+    if (text.starts_with("module")) return 0;
+    return text.find("\nmodule") + 1;
+}
+
+// Symbol uses are normally verified together with the symbol table. Here they
+// are resolved against declarations already present in the parent module.
+mlir::LogicalResult verifySymbolUses(mlir::Operation *op) {
+    mlir::SymbolTableCollection symbolTables;
+    auto result = op->walk([&](mlir::SymbolUserOpInterface user) {
+        if (failed(user.verifySymbolUses(symbolTables))) return mlir::WalkResult::interrupt();
+        return mlir::WalkResult::advance();
+    });
+    return mlir::failure(result.wasInterrupted());
+}
+
+}  // namespace
+
+ModuleStreamer::ModuleStreamer(llvm::raw_ostream &os, mlir::OpPrintingFlags flags)
+    : os(os), flags(flags) {}
+
+ModuleStreamer::~ModuleStreamer() {
+    body.reset();
+    if (!bodyPath.empty()) llvm::sys::fs::remove(bodyPath);
+}
+
+bool ModuleStreamer::open() {
+    int fd;
+    llvm::SmallString<128> path;
+    if (auto ec = llvm::sys::fs::createTemporaryFile("p4mlir-translate", "mlir", fd, path)) {
+        ::P4::error("Failed to create temporary file: %1%", ec.message());
+        return false;
+    }
+    bodyPath = path.str().str();
+    body = std::make_unique<llvm::raw_fd_ostream>(fd, /*shouldClose=*/true);
+    return true;
+}
+
+mlir::LogicalResult ModuleStreamer::emit(mlir::Operation *op) {
+    if (failed(mlir::verify(op)) || failed(verifySymbolUses(op))) {
+        op->emitError("module verification error");
+        return mlir::failure();
+    }
+
+    op->walk([&](mlir::Operation *nested) {
+        aliasRoots.insert(nested->getAttrDictionary());
+        for (auto type : nested->getResultTypes()) aliasRoots.insert(mlir::TypeAttr::get(type));
+        for (auto &region : nested->getRegions())
+            for (auto &block : region)
+                for (auto arg : block.getArguments())
+                    aliasRoots.insert(mlir::TypeAttr::get(arg.getType()));
+    });
+
+    // The operation is printed alone in a module, so it gets the same
+    // indentation and value names as in the complete one. Only the lines
+    // between the module braces are kept.
+    auto *block = op->getBlock();
+    auto *next = op->getNextNode();
+    auto scratch = mlir::ModuleOp::create(op->getLoc());
+    op->moveBefore(scratch.getBody(), scratch.getBody()->end());
+    std::string text = printToString(scratch, flags);
+    op->moveBefore(block, next ? next->getIterator() : block->end());
+    scratch->erase();
+
+    llvm::StringRef lines(text);
+    lines = lines.drop_front(skipAliases(lines));
+    lines = lines.drop_front(lines.find('\n') + 1);
+    lines = lines.take_front(lines.rfind("\n}\n") + 1);
+    *body << lines;
+    return mlir::success();
+}
+
+mlir::LogicalResult ModuleStreamer::finish(mlir::ModuleOp module) {
+    body->close();
+    if (body->has_error()) {
+        ::P4::error("Failed to write temporary file %1%: %2%", bodyPath,
+                    body->error().message());
+        body->clear_error();
+        return mlir::failure();
+    }
+
+    auto *context = module.getContext();
+
+    // Alias definitions are printed for an empty module holding everything
+    // the emitted operations refer to, so they are the same and in the same
+    // order as for the complete module
+    aliasRoots.insert(module->getAttrDictionary());
+    auto holder = mlir::ModuleOp::create(module.getLoc());
+    holder->setAttr("p4mlir.aliases", mlir::ArrayAttr::get(context, aliasRoots.getArrayRef()));
+    std::string aliases = printToString(holder, flags);
+    holder->erase();
+
+    // The module line with the name and attributes of the module
+    auto shell = mlir::ModuleOp::create(module.getLoc(), module.getSymName());
+    for (auto attr : module->getDiscardableAttrs()) shell->setAttr(attr.getName(), attr.getValue());
+    std::string header = printToString(shell, flags);
+    shell->erase();
+
+    auto bodyText = llvm::MemoryBuffer::getFile(bodyPath);
+    if (!bodyText) {
+        ::P4::error("Failed to read temporary file %1%: %2%", bodyPath,
+                    bodyText.getError().message());
+        return mlir::failure();
+    }
+
+    llvm::StringRef headerText(header);
+    headerText = headerText.drop_front(skipAliases(headerText));
+    os << llvm::StringRef(aliases).take_front(skipAliases(aliases))
+       << headerText.take_front(headerText.find('\n') + 1) << (*bodyText)->getBuffer() << "}\n";
+    return mlir::success();
+}
+
+}  // namespace P4::MLIR
@@ -0,0 +1,64 @@
+/*
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _P4MLIR_STREAM_H_
+#define _P4MLIR_STREAM_H_
+
+#include <memory>
+#include <string>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/OperationSupport.h"
+#pragma GCC diagnostic pop
+
+namespace P4::MLIR {
+
+// Verifies and prints top-level operations of a module one by one as they
+// are converted, so the whole module never needs to be in memory. The output
+// is the same as of printing the complete module. As alias definitions go
+// before the module, printed operations are kept in a temporary file until
+// all of them are known.
+class ModuleStreamer {
+ public:
+    ModuleStreamer(llvm::raw_ostream &os, mlir::OpPrintingFlags flags);
+    ~ModuleStreamer();
+
+    // Creates the temporary file. Returns false and reports an error on
+    // failure.
+    bool open();
+
+    // Verifies and prints the operation. Symbols it uses should be already
+    // declared in its parent module.
+    mlir::LogicalResult emit(mlir::Operation *op);
+
+    // Writes the module with all the emitted operations to the output
+    mlir::LogicalResult finish(mlir::ModuleOp module);
+
+ private:
+    llvm::raw_ostream &os;
+    mlir::OpPrintingFlags flags;
+    std::string bodyPath;
+    std::unique_ptr<llvm::raw_fd_ostream> body;
+    // Attributes and types (as TypeAttr) of the emitted operations, aliases
+    // are defined for
+    llvm::SetVector<mlir::Attribute> aliasRoots;
+};
+
+}  // namespace P4::MLIR
+
+#endif /* _P4MLIR_STREAM_H_ */
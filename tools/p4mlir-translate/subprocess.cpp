@@ -0,0 +1,154 @@
+/*
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "subprocess.h"
+
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "lib/error.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#include "llvm/Support/raw_ostream.h"
+#pragma GCC diagnostic pop
+
+namespace P4::MLIR {
+
+namespace {
+
+void flushStreams() {
+    std::cout.flush();
+    std::cerr.flush();
+    llvm::outs().flush();
+    llvm::errs().flush();
+}
+
+struct Subprocess {
+    pid_t pid;
+    // Read end of the pipe the process writes its output into
+    int fd;
+    size_t index;
+    std::string output;
+};
+
+// Forks a process running 'body' for the given index. Read ends of the pipes
+// of 'running' processes are closed in the new one.
+std::optional<Subprocess> start(size_t index, const std::vector<Subprocess> &running,
+                                const std::function<bool(size_t index, int fd)> &body) {
+    int fds[2];
+    if (::pipe(fds) < 0) {
+        ::P4::error("Failed to create pipe: %1%", std::strerror(errno));
+        return std::nullopt;
+    }
+
+    // Otherwise output buffered so far would be written by both processes
+    flushStreams();
+    auto pid = ::fork();
+    if (pid < 0) {
+        ::P4::error("Failed to fork: %1%", std::strerror(errno));
+        ::close(fds[0]);
+        ::close(fds[1]);
+        return std::nullopt;
+    }
+
+    if (pid == 0) {
+        ::close(fds[0]);
+        for (const auto &process : running) ::close(process.fd);
+        bool succeeded = body(index, fds[1]);
+        ::close(fds[1]);
+        // Skip destructors of the state shared with the parent
+        flushStreams();
+        ::_exit(succeeded ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    ::close(fds[1]);
+    return Subprocess{pid, fds[0], index, {}};
+}
+
+// Waits for the process to exit. Returns its output if it has succeeded.
+std::optional<std::string> finish(Subprocess &process) {
+    ::close(process.fd);
+
+    int status = 0;
+    while (::waitpid(process.pid, &status, 0) < 0) {
+        if (errno == EINTR) continue;
+        ::P4::error("Failed to wait for process %1%: %2%", process.pid, std::strerror(errno));
+        return std::nullopt;
+    }
+
+    if (WIFSIGNALED(status))
+        std::cerr << "Process " << process.pid << " was killed by signal " << WTERMSIG(status)
+                  << std::endl;
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) return std::nullopt;
+    return std::move(process.output);
+}
+
+}  // namespace
+
+std::optional<std::string> runInSubprocess(const std::function<bool(int fd)> &body) {
+    auto outputs = runInSubprocesses(1, 1, [&](size_t, int fd) { return body(fd); });
+    return std::move(outputs.front());
+}
+
+std::vector<std::optional<std::string>> runInSubprocesses(
+    size_t count, unsigned maxProcesses, const std::function<bool(size_t index, int fd)> &body) {
+    std::vector<std::optional<std::string>> outputs(count);
+    std::vector<Subprocess> running;
+    size_t next = 0;
+    char buffer[65536];
+    while (next < count || !running.empty()) {
+        while (next < count && running.size() < std::max(maxProcesses, 1u)) {
+            if (auto process = start(next, running, body)) running.push_back(std::move(*process));
+            ++next;
+        }
+        if (running.empty()) continue;
+
+        std::vector<pollfd> fds;
+        for (const auto &process : running) fds.push_back({process.fd, POLLIN, 0});
+        if (::poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            // Processes still running are killed by SIGPIPE once they write
+            ::P4::error("Failed to wait for process output: %1%", std::strerror(errno));
+            for (auto &process : running) finish(process);
+            running.clear();
+            continue;
+        }
+
+        // Going backwards, so finished processes could be removed in place
+        for (size_t i = fds.size(); i-- > 0;) {
+            if (fds[i].revents == 0) continue;
+            auto &process = running[i];
+            auto n = ::read(process.fd, buffer, sizeof(buffer));
+            if (n < 0 && errno == EINTR) continue;
+            if (n > 0) {
+                process.output.append(buffer, n);
+                continue;
+            }
+            outputs[process.index] = finish(process);
+            running.erase(running.begin() + i);
+        }
+    }
+
+    return outputs;
+}
+
+}  // namespace P4::MLIR
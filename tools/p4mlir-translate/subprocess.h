@@ -0,0 +1,44 @@
+/*
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _P4MLIR_SUBPROCESS_H_
+#define _P4MLIR_SUBPROCESS_H_
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace P4::MLIR {
+
+// Runs 'body' in a forked process and returns everything it has written into
+// the file descriptor passed to it. Returns std::nullopt if the body returns
+// false or the process could not be started or has crashed. The body is
+// expected to report its own errors, the standard streams are shared.
+//
+// Memory used by the body, including the garbage that is never collected
+// while GC is disabled, is returned to the system once the process exits.
+// Threads do not survive fork(), so the body should not rely on the threads
+// already started by the caller (e.g. by thread pools).
+std::optional<std::string> runInSubprocess(const std::function<bool(int fd)> &body);
+
+// Runs 'body' for each index from 0 to 'count' - 1 as runInSubprocess does,
+// with at most 'maxProcesses' processes running at once. Returns the outputs
+// by index.
+std::vector<std::optional<std::string>> runInSubprocesses(
+    size_t count, unsigned maxProcesses, const std::function<bool(size_t index, int fd)> &body);
+
+}  // namespace P4::MLIR
+
+#endif /* _P4MLIR_SUBPROCESS_H_ */
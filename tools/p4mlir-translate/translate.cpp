@@ -2,17 +2,29 @@
 
 #include <algorithm>
 #include <climits>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <variant>
+#include <vector>
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wcovered-switch-default"
 #include "frontends/common/resolveReferences/resolveReferences.h"
 #include "frontends/p4/methodInstance.h"
 #include "frontends/p4/typeMap.h"
+#include "gc/gc.h"
 #include "ir/ir.h"
 #include "ir/visitor.h"
 #include "lib/big_int.h"
 #include "lib/indent.h"
 #include "lib/log.h"
+#include "lib/source_file.h"
 #pragma GCC diagnostic pop
 
 #include "p4mlir/Dialect/P4HIR/P4HIR_Attrs.h"
@@ -23,10 +35,15 @@
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseMapInfoVariant.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/ScopedHashTable.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/raw_ostream.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/Builders.h"
@@ -35,41 +52,110 @@
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/Location.h"
 #include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/IR/Types.h"
 #include "mlir/IR/Value.h"
-#include "mlir/IR/Verifier.h"
 #pragma GCC diagnostic pop
 
 using namespace P4::P4MLIR;
 
 namespace {
 
-// Converts P4 SourceLocation stored in 'node' into its MLIR counterpart
-mlir::Location getLoc(mlir::OpBuilder &builder, const P4::IR::Node *node) {
-    CHECK_NULL(node);
-    auto sourceInfo = node->getSourceInfo();
-    if (!sourceInfo.isValid()) return mlir::UnknownLoc::get(builder.getContext());
+// Converts P4 source positions into MLIR locations. File names are interned
+// once and locations of the same source position are reused, so contexts
+// do not need to unique them again.
+class LocationCache {
+ public:
+    LocationCache(mlir::MLIRContext *context, LocationMode mode,
+                  const LocationCache *parent = nullptr)
+        : context(context), mode(mode), parent(parent) {}
 
-    const auto &start = sourceInfo.getStart();
+    LocationMode getMode() const { return mode; }
 
-    return mlir::FileLineColLoc::get(
-        builder.getStringAttr(sourceInfo.getSourceFile().string_view()), start.getLineNumber(),
-        start.getColumnNumber());
-}
+    // Location of the node start (or the whole node in range mode)
+    mlir::Location getLoc(const P4::IR::Node *node) {
+        CHECK_NULL(node);
+        auto sourceInfo = node->getSourceInfo();
+        if (!sourceInfo.isValid()) return mlir::UnknownLoc::get(context);
 
-mlir::Location getEndLoc(mlir::OpBuilder &builder, const P4::IR::Node *node) {
-    CHECK_NULL(node);
-    auto sourceInfo = node->getSourceInfo();
-    if (!sourceInfo.isValid()) return mlir::UnknownLoc::get(builder.getContext());
+        const auto &start = sourceInfo.getStart();
+        if (mode != LocationMode::Range) return getPointLoc(sourceInfo, start);
 
-    const auto &end = sourceInfo.getEnd();
+        const auto &end = sourceInfo.getEnd();
+        Key key{start.getLineNumber(), start.getColumnNumber(), end.getLineNumber(),
+                end.getColumnNumber()};
+        if (auto loc = lookup(key)) return loc;
 
-    return mlir::FileLineColLoc::get(
-        builder.getStringAttr(sourceInfo.getSourceFile().string_view()), end.getLineNumber(),
-        end.getColumnNumber());
-}
+        mlir::LocationAttr loc = mlir::FusedLoc::get(
+            context, {getPointLoc(sourceInfo, start), getPointLoc(sourceInfo, end)});
+        return locations.try_emplace(key, loc).first->second;
+    }
+
+    mlir::Location getEndLoc(const P4::IR::Node *node) {
+        CHECK_NULL(node);
+        auto sourceInfo = node->getSourceInfo();
+        if (!sourceInfo.isValid()) return mlir::UnknownLoc::get(context);
+
+        return getPointLoc(sourceInfo, sourceInfo.getEnd());
+    }
+
+ private:
+    // Start line and column, end line and column of the source range. Lines
+    // are numbered from 1, so single positions have zero end.
+    using Key = std::tuple<unsigned, unsigned, unsigned, unsigned>;
+
+    mlir::Location getPointLoc(const P4::Util::SourceInfo &sourceInfo,
+                               const P4::Util::SourcePosition &pos) {
+        unsigned column = mode == LocationMode::Line ? 0 : pos.getColumnNumber();
+        Key key{pos.getLineNumber(), column, 0, 0};
+        if (auto loc = lookup(key)) return loc;
+
+        mlir::LocationAttr loc =
+            mlir::FileLineColLoc::get(getFileName(sourceInfo), pos.getLineNumber(), column);
+        return locations.try_emplace(key, loc).first->second;
+    }
+
+    mlir::StringAttr getFileName(const P4::Util::SourceInfo &sourceInfo) {
+        // Source file names are interned by P4C, so they are keyed by pointer
+        auto file = sourceInfo.getSourceFile();
+        if (auto name = lookupFileName(file.c_str())) return name;
+
+        auto name = mlir::StringAttr::get(context, file.string_view());
+        return fileNames.try_emplace(file.c_str(), name).first->second;
+    }
+
+    // Parent cache is not modified while workers are running, so it could be
+    // safely read concurrently
+    mlir::LocationAttr lookup(const Key &key) const {
+        if (auto loc = locations.lookup(key)) return loc;
+        return parent ? parent->lookup(key) : nullptr;
+    }
+
+    mlir::StringAttr lookupFileName(const char *file) const {
+        if (auto name = fileNames.lookup(file)) return name;
+        return parent ? parent->lookupFileName(file) : nullptr;
+    }
+
+    mlir::MLIRContext *context;
+    LocationMode mode;
+    const LocationCache *parent;
+    llvm::DenseMap<Key, mlir::LocationAttr> locations;
+    llvm::DenseMap<const char *, mlir::StringAttr> fileNames;
+};
 
 mlir::APInt toAPInt(const P4::big_int &value, unsigned bitWidth = 0) {
+    // Most of constants fit into a single word, convert them without
+    // exporting into a temporary vector
+    const P4::big_int magnitude = value < 0 ? P4::big_int(-value) : value;
+    if (magnitude <= std::numeric_limits<uint64_t>::max()) {
+        uint64_t word = static_cast<uint64_t>(magnitude);
+        mlir::APInt apValue(bitWidth ? bitWidth : 64, llvm::ArrayRef<uint64_t>(word));
+        if (value < 0) apValue.negate();
+
+        return apValue;
+    }
+
     std::vector<uint64_t> valueBits;
     // Export absolute value into 64-bit unsigned values, most significant bit last
     export_bits(value, std::back_inserter(valueBits), 64, false);
@@ -85,13 +171,288 @@ mlir::APInt toAPInt(const P4::big_int &value, unsigned bitWidth = 0) {
 class P4HIRConverter;
 class P4TypeConverter;
 
+// Thrown by a worker converter when a name is missing in the declaration
+// index. Resolving it would involve P4 runtime that is not thread-safe, so the
+// body is converted again on the main thread instead.
+struct SerialConversionRequired {};
+
+// Registers the current thread with the garbage collector for the lifetime
+// of the object unless it is already registered. All the allocations, not
+// only P4 IR ones, go through the collector, so it should know all the
+// threads that allocate.
+class GCThreadRegistration {
+ public:
+    GCThreadRegistration() {
+        if (GC_thread_is_registered()) return;
+        GC_stack_base stackBase;
+        if (GC_get_stack_base(&stackBase) == GC_SUCCESS)
+            registered = GC_register_my_thread(&stackBase) == GC_SUCCESS;
+    }
+    ~GCThreadRegistration() {
+        if (registered) GC_unregister_my_thread();
+    }
+
+ private:
+    bool registered = false;
+};
+
 class ConversionTracer {
  public:
-    ConversionTracer(const char *Kind, const P4::IR::Node *node) {
-        // TODO: Add TimeTrace here
+    ConversionTracer(const char *Kind, const P4::IR::Node *node)
+        : timeScope(llvm::StringRef(Kind).rtrim(), [node]() {
+              std::ostringstream os;
+              os << dbp(node);
+              return os.str();
+          }) {
         LOG4(P4::IndentCtl::indent << Kind << dbp(node));
     }
     ~ConversionTracer() { LOG4_UNINDENT; }
+
+ private:
+    llvm::TimeTraceScope timeScope;
+};
+
+// Collects names referenced from a top-level declaration that is not converted
+// to P4HIR function (control, parser, package instantiation, etc.). Actions and
+// functions used there are entry points of the program.
+class EntryPointCollector : public P4::Inspector {
+ public:
+    bool preorder(const P4::IR::PathExpression *pe) override {
+        names.insert(pe->path->name.string_view());
+        return false;
+    }
+
+    llvm::DenseSet<llvm::StringRef> names;
+};
+
+// Returns top-level actions and functions that should be visible outside of
+// the module. Everything else is private and could be removed by symbol DCE
+// when unused. If there is no package instantiation, then everything declared
+// at the top level is an entry point.
+llvm::DenseSet<const P4::IR::Node *> collectEntryPoints(const P4::IR::P4Program *program) {
+    llvm::DenseSet<const P4::IR::Node *> entryPoints;
+    bool hasMain = !program->getDeclsByName(P4::IR::P4Program::main)->toVector().empty();
+
+    EntryPointCollector collector;
+    if (hasMain) {
+        for (const auto *obj : program->objects) {
+            // Calls between top-level actions and functions are symbol uses and
+            // are tracked by symbol DCE itself
+            if (obj->is<P4::IR::P4Action>() || obj->is<P4::IR::Function>() ||
+                obj->is<P4::IR::Method>())
+                continue;
+            obj->apply(collector);
+        }
+    }
+
+    for (const auto *obj : program->objects) {
+        const auto *decl = obj->to<P4::IR::IDeclaration>();
+        if (!decl || !(obj->is<P4::IR::P4Action>() || obj->is<P4::IR::Function>())) continue;
+        if (!hasMain || collector.names.contains(decl->getName().string_view()))
+            entryPoints.insert(obj);
+    }
+
+    return entryPoints;
+}
+
+// Declarations of a single scope by name, built once for each scope names are
+// looked up in. Declarations of nested namespaces (e.g. type and constructor
+// parameters of a control) are visible in the scope as well.
+class ScopeTable {
+ public:
+    explicit ScopeTable(const P4::IR::INamespace *ns)
+        : ordered(!ns->is<P4::IR::IGeneralNamespace>()) {
+        add(ns);
+        if (const auto *nested = ns->to<P4::IR::INestedNamespace>())
+            for (const auto *nestedNs : nested->getNestedNamespaces()) add(nestedNs);
+    }
+
+    llvm::ArrayRef<const P4::IR::IDeclaration *> lookup(llvm::StringRef name) const {
+        auto it = decls.find(name);
+        if (it == decls.end()) return {};
+        return it->second;
+    }
+
+    // Declarations of ordered scopes (e.g. blocks) are only visible after
+    // they are declared
+    bool isOrdered() const { return ordered; }
+
+ private:
+    void add(const P4::IR::INamespace *ns) {
+        for (const auto *decl : *ns->getDeclarations())
+            decls[decl->getName().string_view()].push_back(decl);
+    }
+
+    bool ordered;
+    llvm::StringMap<llvm::SmallVector<const P4::IR::IDeclaration *, 1>> decls;
+};
+
+// Resolves names used in top-level declarations, so declarations of paths,
+// called methods and named types could be looked up by the converter in
+// constant time. Names are resolved via tables of the enclosing scopes, so
+// each step up the scope chain is a single hash lookup rather than a scan of
+// the scope declarations. Ambiguous names (e.g. overloaded functions) and
+// names not found in the tables are left to the regular resolution.
+// Declarations are indexed on demand, right before they are walked by the
+// converter, so nothing is resolved in the parts of the program that are not
+// converted.
+class DeclarationIndex : public P4::Inspector, public P4::ResolutionContext {
+ public:
+    explicit DeclarationIndex(P4::TypeMap *typeMap) : typeMap(typeMap) {
+        CHECK_NULL(typeMap);
+        setName("DeclarationIndex");
+    }
+
+    // Indexes names used in the top-level declaration 'decl' unless already
+    // done. 'programCtxt' is the context of the program node, so the names
+    // are resolved in the program scope.
+    void indexDeclaration(const P4::IR::Node *decl, const Context *programCtxt) {
+        if (indexed.insert(decl).second) decl->apply(*this, programCtxt);
+    }
+
+    bool preorder(const P4::IR::PathExpression *pe) override {
+        paths.try_emplace(pe->path, getDeclaration(pe->path));
+        return false;
+    }
+
+    bool preorder(const P4::IR::Type_Name *name) override {
+        const auto *decl = lookupInScopes(name->path, /*isType=*/true);
+        types.try_emplace(name,
+                          decl ? decl->getNode()->checkedTo<P4::IR::Type>() : resolveType(name));
+        return false;
+    }
+
+    bool preorder(const P4::IR::MethodCallExpression *mce) override {
+        methods.try_emplace(
+            mce, P4::MethodInstance::resolve(mce, this, typeMap, false, getChildContext()));
+        return true;
+    }
+
+    // Also used by MethodInstance::resolve, so called methods are looked up
+    // in the scope tables as well
+    using ResolutionContext::getDeclaration;
+    const P4::IR::IDeclaration *getDeclaration(const P4::IR::Path *path,
+                                               bool notNull = false) const override {
+        if (const auto *decl = lookupInScopes(path, /*isType=*/false)) return decl;
+        return ResolutionContext::getDeclaration(path, notNull);
+    }
+
+    // All lookups return null for nodes that are not part of the indexed program
+    const P4::IR::IDeclaration *lookupPath(const P4::IR::Path *path) const {
+        return paths.lookup(path);
+    }
+    const P4::IR::Type *lookupType(const P4::IR::Type_Name *name) const {
+        return types.lookup(name);
+    }
+    const P4::MethodInstance *lookupMethodInstance(const P4::IR::MethodCallExpression *mce) const {
+        return methods.lookup(mce);
+    }
+
+ private:
+    // Looks the path up in the scopes enclosing the current node, innermost
+    // first. Returns nullptr if the name is not found or is ambiguous.
+    const P4::IR::IDeclaration *lookupInScopes(const P4::IR::Path *path, bool isType) const {
+        const auto &name = path->name;
+        for (const auto *ctxt = getChildContext(); ctxt; ctxt = ctxt->parent) {
+            // Absolute paths refer to the program scope, which is the outermost one
+            if (path->absolute && ctxt->parent) continue;
+            const auto *ns = ctxt->node->to<P4::IR::INamespace>();
+            if (!ns) continue;
+
+            const auto &scope = getScope(ns);
+            const P4::IR::IDeclaration *found = nullptr;
+            for (const auto *decl : scope.lookup(name.string_view())) {
+                if (isType && !decl->is<P4::IR::Type>()) continue;
+                if (scope.isOrdered() && !isDeclaredBefore(decl, name.getSourceInfo())) continue;
+                if (found) return nullptr;
+                found = decl;
+            }
+            if (found) return found;
+        }
+        return nullptr;
+    }
+
+    static bool isDeclaredBefore(const P4::IR::IDeclaration *decl,
+                                 const P4::Util::SourceInfo &use) {
+        auto declInfo = decl->getNode()->getSourceInfo();
+        if (!declInfo.isValid() || !use.isValid()) return true;
+        return declInfo.getStart() < use.getStart();
+    }
+
+    const ScopeTable &getScope(const P4::IR::INamespace *ns) const {
+        auto &scope = scopes[ns];
+        if (!scope) scope = std::make_unique<ScopeTable>(ns);
+        return *scope;
+    }
+
+    P4::TypeMap *typeMap;
+    llvm::DenseSet<const P4::IR::Node *> indexed;
+    mutable llvm::DenseMap<const P4::IR::INamespace *, std::unique_ptr<ScopeTable>> scopes;
+    llvm::DenseMap<const P4::IR::Path *, const P4::IR::IDeclaration *> paths;
+    llvm::DenseMap<const P4::IR::Type_Name *, const P4::IR::Type *> types;
+    llvm::DenseMap<const P4::IR::MethodCallExpression *, const P4::MethodInstance *> methods;
+};
+
+// Collects top-level declarations reachable from the given roots via names
+// and types they reference, so only these need to be converted. Actions and
+// functions referenced from reachable declarations that are not converted to
+// P4HIR functions (control, parser, package instantiation, etc.) and the
+// roots themselves are entry points of the program.
+class ReachabilityCollector : public P4::Inspector {
+ public:
+    ReachabilityCollector(const P4::IR::P4Program *program, DeclarationIndex &index,
+                          const Context *programCtxt)
+        : index(index), programCtxt(programCtxt) {
+        setName("ReachabilityCollector");
+        for (const auto *obj : program->objects) topLevel.insert(obj);
+    }
+
+    void addRoot(const P4::IR::Node *root) {
+        if (isFunction(root)) entryPoints.insert(root);
+        add(root);
+    }
+
+    void run() {
+        while (!worklist.empty()) {
+            current = worklist.pop_back_val();
+            index.indexDeclaration(current, programCtxt);
+            current->apply(*this);
+        }
+    }
+
+    bool preorder(const P4::IR::PathExpression *pe) override {
+        if (const auto *decl = index.lookupPath(pe->path)) add(decl->getNode());
+        return false;
+    }
+
+    bool preorder(const P4::IR::Type_Name *name) override {
+        if (const auto *type = index.lookupType(name)) add(type);
+        return false;
+    }
+
+    llvm::DenseSet<const P4::IR::Node *> reachable;
+    llvm::DenseSet<const P4::IR::Node *> entryPoints;
+
+ private:
+    static bool isFunction(const P4::IR::Node *node) {
+        return node->is<P4::IR::P4Action>() || node->is<P4::IR::Function>() ||
+               node->is<P4::IR::Method>();
+    }
+
+    void add(const P4::IR::Node *node) {
+        // Local declarations are converted together with their enclosing one
+        if (!topLevel.contains(node)) return;
+        if (current && !isFunction(current) &&
+            (node->is<P4::IR::P4Action>() || node->is<P4::IR::Function>()))
+            entryPoints.insert(node);
+        if (reachable.insert(node).second) worklist.push_back(node);
+    }
+
+    DeclarationIndex &index;
+    const Context *programCtxt;
+    llvm::DenseSet<const P4::IR::Node *> topLevel;
+    llvm::SmallVector<const P4::IR::Node *, 16> worklist;
+    const P4::IR::Node *current = nullptr;
 };
 
 // A dedicated converter for conversion of the P4 types to their destination
@@ -112,19 +473,19 @@ class P4TypeConverter : public P4::Inspector {
         return false;
     }
 
-    bool preorder(const P4::IR::Type *type) override {
-        ::P4::error("%1%: P4 type not yet supported.", dbp(type));
-        return false;
-    }
-
+    bool preorder(const P4::IR::Type *type) override;
     bool preorder(const P4::IR::Type_Bits *type) override;
     bool preorder(const P4::IR::Type_InfInt *type) override;
     bool preorder(const P4::IR::Type_Boolean *type) override;
     bool preorder(const P4::IR::Type_Unknown *type) override;
     bool preorder(const P4::IR::Type_Typedef *type) override {
+        // Cache typedefs themselves, so all names referring to the same
+        // typedef share its conversion
+        if ((this->type = converter.findType(type))) return false;
+
         ConversionTracer trace("TypeConverting ", type);
         visit(type->type);
-        return false;
+        return setType(type, getType());
     }
 
     bool preorder(const P4::IR::Type_Name *name) override;
@@ -146,16 +507,82 @@ class P4HIRConverter : public P4::Inspector, public P4::ResolutionContext {
 
     P4::TypeMap *typeMap = nullptr;
     llvm::DenseMap<const P4::IR::Type *, mlir::Type> p4Types;
-    // TODO: Implement unified constant map
-    // using CTVOrExpr = std::variant<const P4::IR::CompileTimeValue *,
-    //                                const P4::IR::Expression *>;
-    // llvm::DenseMap<CTVOrExpr, mlir::TypedAttr> p4Constants;
-    llvm::DenseMap<const P4::IR::Expression *, mlir::TypedAttr> p4Constants;
-    llvm::DenseMap<const P4::IR::Node *, mlir::Value> p4Values;
+    // Bit types by width and signedness
+    llvm::DenseMap<std::pair<int, unsigned>, mlir::Type> bitsTypes;
+    // Converted values and constants are scoped: entries created within a
+    // function, action, block or region are dropped once it is converted, so
+    // the maps do not grow with the size of the whole program.
+    using CTVOrExpr =
+        std::variant<const P4::IR::CompileTimeValue *, const P4::IR::Expression *>;
+    using ConstantTable = llvm::ScopedHashTable<CTVOrExpr, mlir::TypedAttr>;
+    using ValueTable = llvm::ScopedHashTable<const P4::IR::Node *, mlir::Value>;
+    ConstantTable p4Constants;
+    ValueTable p4Values;
     using P4Symbol =
         std::variant<const P4::IR::P4Action *, const P4::IR::Function *, const P4::IR::Method *>;
-    // TODO: Implement better scoped symbol table
+    // Callees are resolved to their declaration nodes via declaration index,
+    // so no scoping is necessary here: declarations are unique.
     llvm::DenseMap<P4Symbol, mlir::SymbolRefAttr> p4Symbols;
+    llvm::DenseSet<const P4::IR::Node *> entryPoints;
+    DeclarationIndex declarations;
+    // Names of top-level declarations to start conversion from. If empty,
+    // the whole program is converted.
+    llvm::SmallVector<std::string, 4> roots;
+    LocationCache locations;
+
+    // Function or action whose body is converted separately from its
+    // declaration. 'ctxt' is the visitor context of the declaration, so the
+    // body is resolved in its own scope when walked separately.
+    struct FunctionBody {
+        const P4::IR::Node *decl;
+        const P4::IR::ParameterList *params;
+        const P4::IR::BlockStatement *body;
+        P4HIR::FuncOp func;
+        Context ctxt;
+    };
+
+    // When set, bodies of functions and actions are collected while the
+    // program is walked and converted in parallel after all symbols are
+    // created. Each body is converted by its own worker converter that refers
+    // to the parent one for declarations, symbols, types and top-level values.
+    bool deferBodies = false;
+    std::vector<FunctionBody> deferredBodies;
+    const P4HIRConverter *parent = nullptr;
+    // Set for workers running concurrently: these make no calls into P4
+    // runtime that allocate or modify shared state, see SerialConversionRequired
+    bool concurrent = false;
+    // Errors could not be reported from worker threads, they are replayed in
+    // program order once all bodies are converted
+    std::vector<std::function<void()>> *deferredErrors = nullptr;
+
+    // When set, each distinct constant used in a function or action body is
+    // materialized once at the start of its entry block
+    bool hoistConstants = false;
+    P4HIR::FuncOp currentFunc;
+    llvm::DenseMap<mlir::Attribute, P4HIR::ConstOp> hoistedConstants;
+    P4HIR::ConstOp lastHoistedConstant;
+
+    // Receives top-level operations as soon as they are converted, see
+    // ConversionOptions::streamOp
+    std::function<mlir::LogicalResult(mlir::Operation *)> streamOp;
+    mlir::Operation *lastStreamedOp = nullptr;
+    bool streamFailed = false;
+
+    ConversionStats stats;
+
+    // Opens new scope for converted values and constants
+    class ConversionScope {
+     public:
+        explicit ConversionScope(P4HIRConverter &converter)
+            : constants(converter.p4Constants), values(converter.p4Values) {}
+
+     private:
+        ConstantTable::ScopeTy constants;
+        ValueTable::ScopeTy values;
+    };
+
+    // Top-level declarations (e.g. constants)
+    ConversionScope globalScope{*this};
 
     mlir::TypedAttr resolveConstant(const P4::IR::CompileTimeValue *ctv);
     mlir::TypedAttr resolveConstantExpr(const P4::IR::Expression *expr);
@@ -168,19 +595,140 @@ class P4HIRConverter : public P4::Inspector, public P4::ResolutionContext {
     }
 
  public:
-    P4HIRConverter(mlir::OpBuilder &builder, P4::TypeMap *typeMap)
-        : builder(builder), typeMap(typeMap) {
+    P4HIRConverter(mlir::OpBuilder &builder, P4::TypeMap *typeMap, LocationMode locationMode)
+        : builder(builder),
+          typeMap(typeMap),
+          declarations(typeMap),
+          locations(builder.getContext(), locationMode) {
         CHECK_NULL(typeMap);
     }
 
-    mlir::Type findType(const P4::IR::Type *type) const { return p4Types.lookup(type); }
+    // Worker converter for function and action bodies deferred by 'parent'
+    P4HIRConverter(mlir::OpBuilder &builder, const P4HIRConverter &parent,
+                   std::vector<std::function<void()>> &errors, bool concurrent)
+        : builder(builder),
+          typeMap(parent.typeMap),
+          declarations(parent.typeMap),
+          locations(builder.getContext(), parent.locations.getMode(), &parent.locations),
+          parent(&parent),
+          concurrent(concurrent),
+          deferredErrors(&errors),
+          hoistConstants(parent.hoistConstants) {}
+
+    const ConversionStats &getStats() const { return stats; }
+    void setDeferBodies(bool defer) { deferBodies = defer; }
+    void setHoistConstants(bool hoist) { hoistConstants = hoist; }
+    void setRoots(llvm::ArrayRef<std::string> names) { roots.assign(names.begin(), names.end()); }
+    void setStreamOp(std::function<mlir::LogicalResult(mlir::Operation *)> stream) {
+        streamOp = std::move(stream);
+    }
+    bool hasStreamFailed() const { return streamFailed; }
+
+    // Passes top-level operations created since the last call to 'streamOp'
+    // and drops bodies of the passed functions and actions
+    void streamTopLevelOps() {
+        if (!streamOp || streamFailed) return;
+
+        auto *moduleBody = builder.getInsertionBlock();
+        auto it = lastStreamedOp ? std::next(lastStreamedOp->getIterator()) : moduleBody->begin();
+        for (auto &op : llvm::make_range(it, moduleBody->end())) {
+            lastStreamedOp = &op;
+            if (failed(streamOp(&op))) {
+                streamFailed = true;
+                return;
+            }
+            if (auto func = mlir::dyn_cast<P4HIR::FuncOp>(op)) {
+                auto &body = func.getBody();
+                body.dropAllReferences();
+                body.getBlocks().clear();
+            }
+        }
+    }
+
+    // Errors are formatted by 'report' itself, so for workers all the
+    // formatting (including debug printing of nodes) happens on the main
+    // thread when the errors are replayed
+    void reportError(std::function<void()> report) {
+        if (deferredErrors)
+            deferredErrors->push_back(std::move(report));
+        else
+            report();
+    }
+
+    const DeclarationIndex &index() const { return parent ? parent->index() : declarations; }
+
+    // Name resolution goes through the declaration index. Nodes outside of
+    // the program (e.g. types synthesized by type inference) are resolved in
+    // the current context, which concurrent workers leave to the main thread.
+    const P4::IR::Declaration *resolveDeclaration(const P4::IR::PathExpression *pe) {
+        const auto *decl = index().lookupPath(pe->path);
+        if (!decl) {
+            if (concurrent) throw SerialConversionRequired();
+            decl = resolvePath(pe->path, false);
+        }
+        return decl->checkedTo<P4::IR::Declaration>();
+    }
+
+    const P4::IR::Type *resolveTypeName(const P4::IR::Type_Name *name) {
+        if (const auto *type = index().lookupType(name)) return type;
+        if (concurrent) throw SerialConversionRequired();
+        return resolveType(name);
+    }
+
+    const P4::MethodInstance *resolveMethodInstance(const P4::IR::MethodCallExpression *mce) {
+        if (const auto *instance = index().lookupMethodInstance(mce)) return instance;
+        if (concurrent) throw SerialConversionRequired();
+        return P4::MethodInstance::resolve(mce, this, typeMap, false, getChildContext());
+    }
+
+    mlir::SymbolRefAttr lookupSymbol(P4Symbol decl) const {
+        return parent ? parent->lookupSymbol(decl) : p4Symbols.lookup(decl);
+    }
+
+    // Parent tables are not modified while workers are running, so they
+    // could be safely read concurrently
+    mlir::Type findType(const P4::IR::Type *type) const {
+        if (auto mlirType = p4Types.lookup(type)) return mlirType;
+        return parent ? parent->findType(type) : nullptr;
+    }
+
+    mlir::TypedAttr lookupConstant(CTVOrExpr key) const {
+        if (auto cst = p4Constants.lookup(key)) return cst;
+        return parent ? parent->lookupConstant(key) : nullptr;
+    }
+
+    mlir::Value lookupValue(const P4::IR::Node *node) const {
+        if (auto val = p4Values.lookup(node)) return val;
+        return parent ? parent->lookupValue(node) : nullptr;
+    }
 
     void setType(const P4::IR::Type *type, mlir::Type mlirType) {
         auto [it, inserted] = p4Types.try_emplace(type, mlirType);
         BUG_CHECK(inserted, "duplicate conversion for %1%", type);
+        ++stats.types;
+    }
+
+    // Scalar types are converted directly, without type converter, and cached
+    // by their structure rather than by P4 node: every expression has its
+    // own type node, while there are only few distinct scalar types.
+    mlir::Type getScalarType(const P4::IR::Type *type) {
+        if (const auto *bits = type->to<P4::IR::Type_Bits>()) {
+            auto &bitsType = bitsTypes[{bits->width_bits(), bits->isSigned}];
+            if (!bitsType)
+                bitsType = P4HIR::BitsType::get(context(), bits->width_bits(), bits->isSigned);
+            return bitsType;
+        }
+        if (type->is<P4::IR::Type_Boolean>()) return P4HIR::BoolType::get(context());
+        if (type->is<P4::IR::Type_InfInt>()) return P4HIR::InfIntType::get(context());
+        if (type->is<P4::IR::Type_Void>()) return P4HIR::VoidType::get(context());
+        if (type->is<P4::IR::Type_Unknown>()) return P4HIR::UnknownType::get(context());
+        return nullptr;
     }
 
     mlir::Type getOrCreateType(const P4::IR::Type *type) {
+        if (auto mlirType = getScalarType(type)) return mlirType;
+        if (auto mlirType = findType(type)) return mlirType;
+
         P4TypeConverter cvt(*this);
         type->apply(cvt);
         return cvt.getType();
@@ -196,27 +744,25 @@ class P4HIRConverter : public P4::Inspector, public P4::ResolutionContext {
     }
 
     mlir::Value materializeConstantExpr(const P4::IR::Expression *expr);
+    mlir::Value getOrCreateHoistedConstant(mlir::TypedAttr init, mlir::Location loc);
 
-    // TODO: Implement proper CompileTimeValue support
-    /*
     mlir::TypedAttr setConstant(const P4::IR::CompileTimeValue *ctv, mlir::TypedAttr attr) {
-        auto [it, inserted] = p4Constants.try_emplace(ctv, attr);
-        BUG_CHECK(inserted, "duplicate conversion of %1%", ctv);
-        return it->second;
+        BUG_CHECK(!p4Constants.count(ctv), "duplicate conversion of %1%", ctv);
+        p4Constants.insert(ctv, attr);
+        ++stats.constants;
+        return attr;
     }
-    */
 
     mlir::TypedAttr setConstantExpr(const P4::IR::Expression *expr, mlir::TypedAttr attr) {
-        auto [it, inserted] = p4Constants.try_emplace(expr, attr);
-        BUG_CHECK(inserted, "duplicate conversion of %1%", expr);
-        return it->second;
+        BUG_CHECK(!p4Constants.count(expr), "duplicate conversion of %1%", expr);
+        p4Constants.insert(expr, attr);
+        ++stats.constants;
+        return attr;
     }
 
-    // TODO: Implement proper CompileTimeValue support
-    /*
     mlir::TypedAttr getOrCreateConstant(const P4::IR::CompileTimeValue *ctv) {
         BUG_CHECK(!ctv->is<P4::IR::Expression>(), "use getOrCreateConstantExpr() instead");
-        auto cst = p4Constants.lookup(ctv);
+        auto cst = lookupConstant(ctv);
         if (cst) return cst;
 
         cst = resolveConstant(ctv);
@@ -224,10 +770,9 @@ class P4HIRConverter : public P4::Inspector, public P4::ResolutionContext {
         BUG_CHECK(cst, "expected %1% to be converted as constant", ctv);
         return cst;
     }
-    */
 
     mlir::TypedAttr getOrCreateConstantExpr(const P4::IR::Expression *expr) {
-        auto cst = p4Constants.lookup(expr);
+        auto cst = lookupConstant(expr);
         if (cst) return cst;
 
         cst = resolveConstantExpr(expr);
@@ -238,16 +783,14 @@ class P4HIRConverter : public P4::Inspector, public P4::ResolutionContext {
 
     mlir::Value getValue(const P4::IR::Node *node) {
         // If this is a PathExpression, resolve it
-        if (const auto *pe = node->to<P4::IR::PathExpression>()) {
-            node = resolvePath(pe->path, false)->checkedTo<P4::IR::Declaration>();
-        }
+        if (const auto *pe = node->to<P4::IR::PathExpression>()) node = resolveDeclaration(pe);
 
-        auto val = p4Values.lookup(node);
+        auto val = lookupValue(node);
         BUG_CHECK(val, "expected %1% (aka %2%) to be converted", node, dbp(node));
 
         if (mlir::isa<P4HIR::ReferenceType>(val.getType()))
             // Getting value out of variable involves a load.
-            return builder.create<P4HIR::ReadOp>(getLoc(builder, node), val);
+            return builder.create<P4HIR::ReadOp>(getLoc(node), val);
 
         return val;
     }
@@ -262,15 +805,21 @@ class P4HIRConverter : public P4::Inspector, public P4::ResolutionContext {
             LOG4("Converted " << dbp(node) << " -> \"" << s << "\"");
         }
 
-        auto [it, inserted] = p4Values.try_emplace(node, value);
-        BUG_CHECK(inserted, "duplicate conversion of %1%", node);
-        return it->second;
+        BUG_CHECK(!p4Values.count(node), "duplicate conversion of %1%", node);
+        p4Values.insert(node, value);
+        ++stats.values;
+        return value;
     }
 
     mlir::MLIRContext *context() const { return builder.getContext(); }
 
+    mlir::Location getLoc(const P4::IR::Node *node) { return locations.getLoc(node); }
+    mlir::Location getEndLoc(const P4::IR::Node *node) { return locations.getEndLoc(node); }
+
     bool preorder(const P4::IR::Node *node) override {
-        ::P4::error("P4 construct not yet supported: %1% (aka %2%)", node, dbp(node));
+        reportError([node]() {
+            ::P4::error("P4 construct not yet supported: %1% (aka %2%)", node, dbp(node));
+        });
         return false;
     }
 
@@ -281,7 +830,43 @@ class P4HIRConverter : public P4::Inspector, public P4::ResolutionContext {
         return false;
     }
 
-    bool preorder(const P4::IR::P4Program *) override { return true; }
+    // Top-level declarations are visited one by one, so each could be indexed
+    // right before and streamed right after its conversion
+    void convertTopLevel(const P4::IR::Node *obj, const Context *programCtxt) {
+        declarations.indexDeclaration(obj, programCtxt);
+        visit(obj);
+        streamTopLevelOps();
+    }
+
+    bool preorder(const P4::IR::P4Program *program) override {
+        const auto *programCtxt = getChildContext();
+        if (roots.empty()) {
+            entryPoints = collectEntryPoints(program);
+            for (const auto *obj : program->objects) convertTopLevel(obj, programCtxt);
+            // Children are not visited, so postorder is not called either
+            if (!deferredBodies.empty()) convertDeferredBodies();
+            return false;
+        }
+
+        // Convert only declarations reachable from the roots, still in the
+        // program order, so everything is converted before its uses
+        ReachabilityCollector collector(program, declarations, programCtxt);
+        for (const auto &name : roots) {
+            auto decls = program->getDeclsByName(P4::cstring(name))->toVector();
+            if (decls.empty())
+                ::P4::error("%1%: no top-level declaration with this name", name);
+            for (const auto *decl : decls) collector.addRoot(decl->getNode());
+        }
+        collector.run();
+
+        entryPoints = std::move(collector.entryPoints);
+        for (const auto *obj : program->objects)
+            if (collector.reachable.contains(obj)) convertTopLevel(obj, programCtxt);
+        if (!deferredBodies.empty()) convertDeferredBodies();
+        return false;
+    }
+    void convertBody(const FunctionBody &fb);
+    void convertDeferredBodies();
     bool preorder(const P4::IR::P4Action *a) override;
     bool preorder(const P4::IR::Function *f) override;
     bool preorder(const P4::IR::Method *m) override;
@@ -291,14 +876,17 @@ class P4HIRConverter : public P4::Inspector, public P4::ResolutionContext {
         if (getParent<P4::IR::BlockStatement>()) {
             mlir::OpBuilder::InsertionGuard guard(builder);
             auto scope = builder.create<P4HIR::ScopeOp>(
-                getLoc(builder, block),                   /*scopeBuilder=*/
+                getLoc(block),                   /*scopeBuilder=*/
                 [&](mlir::OpBuilder &, mlir::Location) {  // nothing is being yielded
+                    ConversionScope valueScope(*this);
                     visit(block->components);
                 });
             builder.setInsertionPointToEnd(&scope.getScopeRegion().back());
-            builder.create<P4HIR::YieldOp>(getEndLoc(builder, block));
-        } else
+            builder.create<P4HIR::YieldOp>(getEndLoc(block));
+        } else {
+            ConversionScope valueScope(*this);
             visit(block->components);
+        }
         return false;
     }
 
@@ -373,43 +961,36 @@ class P4HIRConverter : public P4::Inspector, public P4::ResolutionContext {
     mlir::Value emitCmp(const P4::IR::Operation_Relation *relop, P4HIR::CmpOpKind kind);
 };
 
-bool P4TypeConverter::preorder(const P4::IR::Type_Bits *type) {
-    if ((this->type = converter.findType(type))) return false;
+bool P4TypeConverter::preorder(const P4::IR::Type *type) {
+    converter.reportError([type]() { ::P4::error("%1%: P4 type not yet supported.", dbp(type)); });
+    return false;
+}
 
-    ConversionTracer trace("TypeConverting ", type);
-    auto mlirType = P4HIR::BitsType::get(converter.context(), type->width_bits(), type->isSigned);
-    return setType(type, mlirType);
+bool P4TypeConverter::preorder(const P4::IR::Type_Bits *type) {
+    this->type = converter.getScalarType(type);
+    return false;
 }
 
 bool P4TypeConverter::preorder(const P4::IR::Type_InfInt *type) {
-    if ((this->type = converter.findType(type))) return false;
-
-    ConversionTracer trace("TypeConverting ", type);
-    auto mlirType = P4HIR::InfIntType::get(converter.context());
-    return setType(type, mlirType);
+    this->type = converter.getScalarType(type);
+    return false;
 }
 
 bool P4TypeConverter::preorder(const P4::IR::Type_Boolean *type) {
-    if ((this->type = converter.findType(type))) return false;
-
-    ConversionTracer trace("TypeConverting ", type);
-    auto mlirType = P4HIR::BoolType::get(converter.context());
-    return setType(type, mlirType);
+    this->type = converter.getScalarType(type);
+    return false;
 }
 
 bool P4TypeConverter::preorder(const P4::IR::Type_Unknown *type) {
-    if ((this->type = converter.findType(type))) return false;
-
-    ConversionTracer trace("TypeConverting ", type);
-    auto mlirType = P4HIR::UnknownType::get(converter.context());
-    return setType(type, mlirType);
+    this->type = converter.getScalarType(type);
+    return false;
 }
 
 bool P4TypeConverter::preorder(const P4::IR::Type_Name *name) {
     if ((this->type = converter.findType(name))) return false;
 
     ConversionTracer trace("TypeConverting ", name);
-    const auto *type = converter.resolveType(name);
+    const auto *type = converter.resolveTypeName(name);
     CHECK_NULL(type);
     mlir::Type mlirType = convert(type);
     return setType(name, mlirType);
@@ -454,11 +1035,8 @@ bool P4TypeConverter::preorder(const P4::IR::Type_Method *type) {
 }
 
 bool P4TypeConverter::preorder(const P4::IR::Type_Void *type) {
-    if ((this->type = converter.findType(type))) return false;
-
-    ConversionTracer trace("TypeConverting ", type);
-    auto mlirType = P4HIR::VoidType::get(converter.context());
-    return setType(type, mlirType);
+    this->type = converter.getScalarType(type);
+    return false;
 }
 
 bool P4TypeConverter::setType(const P4::IR::Type *type, mlir::Type mlirType) {
@@ -476,12 +1054,10 @@ mlir::Type P4TypeConverter::convert(const P4::IR::Type *type) {
 
 mlir::Value P4HIRConverter::resolveReference(const P4::IR::Node *node) {
     // If this is a PathExpression, resolve it
-    if (const auto *pe = node->to<P4::IR::PathExpression>()) {
-        node = resolvePath(pe->path, false)->checkedTo<P4::IR::Declaration>();
-    }
+    if (const auto *pe = node->to<P4::IR::PathExpression>()) node = resolveDeclaration(pe);
 
     // The result is expected to be an l-value
-    auto ref = p4Values.lookup(node);
+    auto ref = lookupValue(node);
     BUG_CHECK(ref, "expected %1% (aka %2%) to be converted", node, dbp(node));
     BUG_CHECK(mlir::isa<P4HIR::ReferenceType>(ref.getType()),
               "expected reference type for node %1%", node);
@@ -539,17 +1115,37 @@ mlir::Value P4HIRConverter::materializeConstantExpr(const P4::IR::Expression *ex
     ConversionTracer trace("Materializing constant expression ", expr);
 
     auto init = getOrCreateConstantExpr(expr);
-    auto loc = getLoc(builder, expr);
+    auto loc = getLoc(expr);
+
+    if (hoistConstants && currentFunc)
+        return setValue(expr, getOrCreateHoistedConstant(init, loc));
 
     auto val = builder.create<P4HIR::ConstOp>(loc, init);
     return setValue(expr, val);
 }
 
+mlir::Value P4HIRConverter::getOrCreateHoistedConstant(mlir::TypedAttr init,
+                                                       mlir::Location loc) {
+    auto &cst = hoistedConstants[init];
+    if (cst) return cst;
+
+    // Keep hoisted constants in order of their first use
+    mlir::OpBuilder::InsertionGuard guard(builder);
+    if (lastHoistedConstant)
+        builder.setInsertionPointAfter(lastHoistedConstant);
+    else
+        builder.setInsertionPointToStart(&currentFunc.getBody().front());
+
+    cst = builder.create<P4HIR::ConstOp>(loc, init);
+    lastHoistedConstant = cst;
+    return cst;
+}
+
 bool P4HIRConverter::preorder(const P4::IR::Declaration_Constant *decl) {
     ConversionTracer trace("Converting ", decl);
 
     auto init = getOrCreateConstantExpr(decl->initializer);
-    auto loc = getLoc(builder, decl);
+    auto loc = getLoc(decl);
 
     auto val = builder.create<P4HIR::ConstOp>(loc, init, decl->name.string_view());
     setValue(decl, val);
@@ -564,11 +1160,11 @@ void P4HIRConverter::postorder(const P4::IR::Declaration_Variable *decl) {
 
     // TODO: Choose better insertion point for alloca (entry BB or so)
     auto var = builder.create<P4HIR::VariableOp>(
-        getLoc(builder, decl), type, mlir::StringAttr::get(context(), decl->name.string_view()));
+        getLoc(decl), type, mlir::StringAttr::get(context(), decl->name.string_view()));
 
     if (const auto *init = decl->initializer) {
         var.setInit(true);
-        builder.create<P4HIR::AssignOp>(getLoc(builder, init), getValue(decl->initializer), var);
+        builder.create<P4HIR::AssignOp>(getLoc(init), getValue(decl->initializer), var);
     }
 
     setValue(decl, var);
@@ -580,27 +1176,27 @@ void P4HIRConverter::postorder(const P4::IR::Cast *cast) {
     auto src = getValue(cast->expr);
     auto destType = getOrCreateType(cast->destType);
 
-    setValue(cast, builder.create<P4HIR::CastOp>(getLoc(builder, cast), destType, src));
+    setValue(cast, builder.create<P4HIR::CastOp>(getLoc(cast), destType, src));
 }
 
 mlir::Value P4HIRConverter::emitUnOp(const P4::IR::Operation_Unary *unop, P4HIR::UnaryOpKind kind) {
-    return builder.create<P4HIR::UnaryOp>(getLoc(builder, unop), kind, getValue(unop->expr));
+    return builder.create<P4HIR::UnaryOp>(getLoc(unop), kind, getValue(unop->expr));
 }
 
 mlir::Value P4HIRConverter::emitBinOp(const P4::IR::Operation_Binary *binop,
                                       P4HIR::BinOpKind kind) {
-    return builder.create<P4HIR::BinOp>(getLoc(builder, binop), kind, getValue(binop->left),
+    return builder.create<P4HIR::BinOp>(getLoc(binop), kind, getValue(binop->left),
                                         getValue(binop->right));
 }
 
 mlir::Value P4HIRConverter::emitConcatOp(const P4::IR::Concat *concatop) {
-    return builder.create<P4HIR::ConcatOp>(getLoc(builder, concatop), getValue(concatop->left),
+    return builder.create<P4HIR::ConcatOp>(getLoc(concatop), getValue(concatop->left),
                                            getValue(concatop->right));
 }
 
 mlir::Value P4HIRConverter::emitCmp(const P4::IR::Operation_Relation *relop,
                                     P4HIR::CmpOpKind kind) {
-    return builder.create<P4HIR::CmpOp>(getLoc(builder, relop), kind, getValue(relop->left),
+    return builder.create<P4HIR::CmpOp>(getLoc(relop), kind, getValue(relop->left),
                                         getValue(relop->right));
 }
 
@@ -663,7 +1259,7 @@ bool P4HIRConverter::preorder(const P4::IR::AssignmentStatement *assign) {
     visit(assign->left);
     visit(assign->right);
     auto ref = resolveReference(assign->left);
-    builder.create<P4HIR::AssignOp>(getLoc(builder, assign), getValue(assign->right), ref);
+    builder.create<P4HIR::AssignOp>(getLoc(assign), getValue(assign->right), ref);
     return false;
 }
 
@@ -674,13 +1270,14 @@ bool P4HIRConverter::preorder(const P4::IR::LOr *lor) {
     visit(lor->left);
 
     auto value = builder.create<P4HIR::TernaryOp>(
-        getLoc(builder, lor), getValue(lor->left),
+        getLoc(lor), getValue(lor->left),
         [&](mlir::OpBuilder &b, mlir::Location loc) {
-            b.create<P4HIR::YieldOp>(getEndLoc(builder, lor->left), getBoolConstant(loc, true));
+            b.create<P4HIR::YieldOp>(getEndLoc(lor->left), getBoolConstant(loc, true));
         },
         [&](mlir::OpBuilder &b, mlir::Location) {
+            ConversionScope valueScope(*this);
             visit(lor->right);
-            b.create<P4HIR::YieldOp>(getEndLoc(builder, lor->right), getValue(lor->right));
+            b.create<P4HIR::YieldOp>(getEndLoc(lor->right), getValue(lor->right));
         });
 
     setValue(lor, value.getResult());
@@ -694,13 +1291,14 @@ bool P4HIRConverter::preorder(const P4::IR::LAnd *land) {
     visit(land->left);
 
     auto value = builder.create<P4HIR::TernaryOp>(
-        getLoc(builder, land), getValue(land->left),
+        getLoc(land), getValue(land->left),
         [&](mlir::OpBuilder &b, mlir::Location) {
+            ConversionScope valueScope(*this);
             visit(land->right);
-            b.create<P4HIR::YieldOp>(getEndLoc(builder, land->right), getValue(land->right));
+            b.create<P4HIR::YieldOp>(getEndLoc(land->right), getValue(land->right));
         },
         [&](mlir::OpBuilder &b, mlir::Location loc) {
-            b.create<P4HIR::YieldOp>(getEndLoc(builder, land->left), getBoolConstant(loc, false));
+            b.create<P4HIR::YieldOp>(getEndLoc(land->left), getBoolConstant(loc, false));
         });
 
     setValue(land, value.getResult());
@@ -715,14 +1313,16 @@ bool P4HIRConverter::preorder(const P4::IR::Mux *mux) {
 
     // Make the value itself
     auto value = builder.create<P4HIR::TernaryOp>(
-        getLoc(builder, mux), getValue(mux->e0),
+        getLoc(mux), getValue(mux->e0),
         [&](mlir::OpBuilder &b, mlir::Location) {
+            ConversionScope valueScope(*this);
             visit(mux->e1);
-            b.create<P4HIR::YieldOp>(getEndLoc(builder, mux->e1), getValue(mux->e1));
+            b.create<P4HIR::YieldOp>(getEndLoc(mux->e1), getValue(mux->e1));
         },
         [&](mlir::OpBuilder &b, mlir::Location) {
+            ConversionScope valueScope(*this);
             visit(mux->e2);
-            b.create<P4HIR::YieldOp>(getEndLoc(builder, mux->e2), getValue(mux->e2));
+            b.create<P4HIR::YieldOp>(getEndLoc(mux->e2), getValue(mux->e2));
         });
 
     setValue(mux, value.getResult());
@@ -738,14 +1338,16 @@ bool P4HIRConverter::preorder(const P4::IR::IfStatement *ifs) {
 
     // Create if itself
     builder.create<P4HIR::IfOp>(
-        getLoc(builder, ifs), getValue(ifs->condition), ifs->ifFalse,
+        getLoc(ifs), getValue(ifs->condition), ifs->ifFalse,
         [&](mlir::OpBuilder &b, mlir::Location) {
+            ConversionScope valueScope(*this);
             visit(ifs->ifTrue);
-            P4HIR::buildTerminatedBody(b, getEndLoc(builder, ifs->ifTrue));
+            P4HIR::buildTerminatedBody(b, getEndLoc(ifs->ifTrue));
         },
         [&](mlir::OpBuilder &b, mlir::Location) {
+            ConversionScope valueScope(*this);
             visit(ifs->ifFalse);
-            P4HIR::buildTerminatedBody(b, getEndLoc(builder, ifs->ifFalse));
+            P4HIR::buildTerminatedBody(b, getEndLoc(ifs->ifFalse));
         });
     return false;
 }
@@ -785,41 +1387,118 @@ bool P4HIRConverter::preorder(const P4::IR::Function *f) {
     ConversionTracer trace("Converting ", f);
 
     auto funcType = mlir::cast<P4HIR::FuncType>(getOrCreateType(f->type));
-    const auto &params = f->getParameters()->parameters;
 
     auto argAttrs = convertParamDirections(f->getParameters(), context());
     assert(funcType.getNumInputs() == argAttrs.size() && "invalid parameter conversion");
 
-    auto func = builder.create<P4HIR::FuncOp>(getLoc(builder, f), f->name.string_view(), funcType,
+    auto func = builder.create<P4HIR::FuncOp>(getLoc(f), f->name.string_view(), funcType,
                                               llvm::ArrayRef<mlir::NamedAttribute>(), argAttrs);
     func.createEntryBlock();
 
+    FunctionBody body{f, f->getParameters(), f->body, func, *getChildContext()};
+    if (deferBodies)
+        deferredBodies.push_back(body);
+    else
+        convertBody(body);
+
+    if (entryPoints.contains(f))
+        mlir::SymbolTable::setSymbolVisibility(func, mlir::SymbolTable::Visibility::Public);
+
+    auto [it, inserted] = p4Symbols.try_emplace(f, mlir::SymbolRefAttr::get(func));
+    BUG_CHECK(inserted, "duplicate translation of %1%", f);
+    ++stats.symbols;
+
+    return false;
+}
+
+void P4HIRConverter::convertBody(const FunctionBody &fb) {
+    ConversionTracer trace("Converting body of ", fb.decl);
+
     // Iterate over parameters again binding parameter values to arguments of first BB
-    auto &body = func.getBody();
+    auto &body = fb.func.getBody();
+    const auto &params = fb.params->parameters;
 
+    // Parameters and everything converted in the body are local to it
+    ConversionScope valueScope(*this);
     assert(body.getNumArguments() == params.size() && "invalid parameter conversion");
     for (auto [param, bodyArg] : llvm::zip(params, body.getArguments())) setValue(param, bodyArg);
 
     // We cannot simply visit each node of the top-level block as
     // ResolutionContext would not be able to resolve declarations there
-    // (sic!)
-    {
-        mlir::OpBuilder::InsertionGuard guard(builder);
-        builder.setInsertionPointToStart(&body.front());
-        visit(f->body);
-
-        // Check if body's last block is not terminated.
-        mlir::Block &b = body.back();
-        if (!b.mightHaveTerminator()) {
-            builder.setInsertionPointToEnd(&b);
-            builder.create<P4HIR::ReturnOp>(getEndLoc(builder, f));
-        }
+    // (sic!). Workers start a new walk from the body within the context of its
+    // declaration.
+    mlir::OpBuilder::InsertionGuard guard(builder);
+    builder.setInsertionPointToStart(&body.front());
+    currentFunc = fb.func;
+    hoistedConstants.clear();
+    lastHoistedConstant = nullptr;
+    if (parent)
+        fb.body->apply(*this, &fb.ctxt);
+    else
+        visit(fb.body);
+    currentFunc = nullptr;
+
+    // Check if body's last block is not terminated.
+    mlir::Block &b = body.back();
+    if (!b.mightHaveTerminator()) {
+        builder.setInsertionPointToEnd(&b);
+        builder.create<P4HIR::ReturnOp>(getEndLoc(fb.decl));
     }
+}
 
-    auto [it, inserted] = p4Symbols.try_emplace(f, mlir::SymbolRefAttr::get(func));
-    BUG_CHECK(inserted, "duplicate translation of %1%", f);
+void P4HIRConverter::convertDeferredBodies() {
+    // Functions and actions are isolated from above, so their bodies could be
+    // populated independently. Each body gets its own builder and converter,
+    // while the order of operations in the module is already fixed by the
+    // serial walk, so the result does not depend on the scheduling.
+    size_t numBodies = deferredBodies.size();
+    std::vector<std::vector<std::function<void()>>> errors(numBodies);
+    std::vector<ConversionStats> workerStats(numBodies);
+    // Exceptions (e.g. failed BUG_CHECKs) are rethrown on the main thread
+    std::vector<std::exception_ptr> failures(numBodies);
+    std::vector<char> needsSerial(numBodies, false);
+
+    auto convert = [&](size_t idx, bool concurrent) {
+        mlir::OpBuilder bodyBuilder(context());
+        P4HIRConverter worker(bodyBuilder, *this, errors[idx], concurrent);
+        worker.convertBody(deferredBodies[idx]);
+        workerStats[idx] = worker.getStats();
+    };
 
-    return false;
+    GC_allow_register_threads();
+    mlir::parallelFor(context(), 0, numBodies, [&](size_t idx) {
+        GCThreadRegistration gcThread;
+        try {
+            convert(idx, /* concurrent = */ true);
+        } catch (const SerialConversionRequired &) {
+            needsSerial[idx] = true;
+        } catch (...) {
+            failures[idx] = std::current_exception();
+        }
+    });
+
+    for (size_t idx = 0; idx < numBodies; ++idx) {
+        if (needsSerial[idx]) {
+            // Drop whatever the worker has converted and start from scratch
+            auto func = deferredBodies[idx].func;
+            auto &body = func.getBody();
+            body.dropAllReferences();
+            body.getBlocks().clear();
+            func.createEntryBlock();
+            errors[idx].clear();
+            convert(idx, /* concurrent = */ false);
+        }
+
+        const auto &bodyStats = workerStats[idx];
+        stats.values += bodyStats.values;
+        stats.constants += bodyStats.constants;
+        stats.types += bodyStats.types;
+        stats.symbols += bodyStats.symbols;
+
+        for (const auto &report : errors[idx]) report();
+        if (failures[idx]) std::rethrow_exception(failures[idx]);
+    }
+    deferredBodies.clear();
 }
 
 // We treat method as an external function (w/o body)
@@ -831,11 +1510,12 @@ bool P4HIRConverter::preorder(const P4::IR::Method *m) {
     auto argAttrs = convertParamDirections(m->getParameters(), context());
     assert(funcType.getNumInputs() == argAttrs.size() && "invalid parameter conversion");
 
-    auto func = builder.create<P4HIR::FuncOp>(getLoc(builder, m), m->name.string_view(), funcType,
+    auto func = builder.create<P4HIR::FuncOp>(getLoc(m), m->name.string_view(), funcType,
                                               llvm::ArrayRef<mlir::NamedAttribute>(), argAttrs);
 
     auto [it, inserted] = p4Symbols.try_emplace(m, mlir::SymbolRefAttr::get(func));
     BUG_CHECK(inserted, "duplicate translation of %1%", m);
+    ++stats.symbols;
 
     return false;
 }
@@ -848,39 +1528,26 @@ bool P4HIRConverter::preorder(const P4::IR::P4Action *act) {
 
     // FIXME: Get rid of typeMap: ensure action knows its type
     auto actType = mlir::cast<P4HIR::FuncType>(getOrCreateType(typeMap->getType(act, true)));
-    const auto &params = act->getParameters()->parameters;
 
     auto argAttrs = convertParamDirections(act->getParameters(), context());
     assert(actType.getNumInputs() == argAttrs.size() && "invalid parameter conversion");
 
     auto action =
-        P4HIR::FuncOp::buildAction(builder, getLoc(builder, act), act->name.string_view(), actType,
+        P4HIR::FuncOp::buildAction(builder, getLoc(act), act->name.string_view(), actType,
                                    llvm::ArrayRef<mlir::NamedAttribute>(), argAttrs);
 
-    // Iterate over parameters again binding parameter values to arguments of first BB
-    auto &body = action.getBody();
-
-    assert(body.getNumArguments() == params.size() && "invalid parameter conversion");
-    for (auto [param, bodyArg] : llvm::zip(params, body.getArguments())) setValue(param, bodyArg);
+    FunctionBody body{act, act->getParameters(), act->body, action, *getChildContext()};
+    if (deferBodies)
+        deferredBodies.push_back(body);
+    else
+        convertBody(body);
 
-    // We cannot simply visit each node of the top-level block as
-    // ResolutionContext would not be able to resolve declarations there
-    // (sic!)
-    {
-        mlir::OpBuilder::InsertionGuard guard(builder);
-        builder.setInsertionPointToStart(&body.front());
-        visit(act->body);
-
-        // Check if body's last block is not terminated.
-        mlir::Block &b = body.back();
-        if (!b.mightHaveTerminator()) {
-            builder.setInsertionPointToEnd(&b);
-            builder.create<P4HIR::ReturnOp>(getEndLoc(builder, act));
-        }
-    }
+    if (entryPoints.contains(act))
+        mlir::SymbolTable::setSymbolVisibility(action, mlir::SymbolTable::Visibility::Public);
 
     auto [it, inserted] = p4Symbols.try_emplace(act, mlir::SymbolRefAttr::get(action));
     BUG_CHECK(inserted, "duplicate translation of %1%", act);
+    ++stats.symbols;
 
     return false;
 }
@@ -892,16 +1559,15 @@ void P4HIRConverter::postorder(const P4::IR::ReturnStatement *ret) {
     // ensure nothing is created afterwards
     if (ret->expression) {
         auto retVal = getValue(ret->expression);
-        builder.create<P4HIR::ReturnOp>(getLoc(builder, ret), retVal);
+        builder.create<P4HIR::ReturnOp>(getLoc(ret), retVal);
     } else {
-        builder.create<P4HIR::ReturnOp>(getLoc(builder, ret));
+        builder.create<P4HIR::ReturnOp>(getLoc(ret));
     }
 }
 
 bool P4HIRConverter::preorder(const P4::IR::MethodCallExpression *mce) {
     ConversionTracer trace("Converting ", mce);
-    const auto *instance =
-        P4::MethodInstance::resolve(mce, this, typeMap, false, getChildContext());
+    const auto *instance = resolveMethodInstance(mce);
     const auto &params = instance->originalMethodType->parameters->parameters;
 
     // TODO: Actions might have some parameters coming from control plane
@@ -948,19 +1614,19 @@ bool P4HIRConverter::preorder(const P4::IR::MethodCallExpression *mce) {
 
         mlir::Value callResult;
         if (const auto *actCall = instance->to<P4::ActionCall>()) {
-            auto actSym = p4Symbols.lookup(actCall->action);
+            auto actSym = lookupSymbol(actCall->action);
             BUG_CHECK(actSym, "expected reference action to be converted: %1%", actCall->action);
 
             b.create<P4HIR::CallOp>(loc, actSym, operands);
         } else if (const auto *fCall = instance->to<P4::FunctionCall>()) {
-            auto fSym = p4Symbols.lookup(fCall->function);
+            auto fSym = lookupSymbol(fCall->function);
             auto callResultType = getOrCreateType(instance->originalMethodType->returnType);
 
             BUG_CHECK(fSym, "expected reference function to be converted: %1%", fCall->function);
 
             callResult = b.create<P4HIR::CallOp>(loc, fSym, callResultType, operands).getResult();
         } else if (const auto *fCall = instance->to<P4::ExternCall>()) {
-            auto fSym = p4Symbols.lookup(fCall->method);
+            auto fSym = lookupSymbol(fCall->method);
             auto callResultType = getOrCreateType(instance->originalMethodType->returnType);
 
             BUG_CHECK(fSym, "expected reference function to be converted: %1%", fCall->method);
@@ -977,28 +1643,33 @@ bool P4HIRConverter::preorder(const P4::IR::MethodCallExpression *mce) {
             mlir::Value copyOut = operands[idx];
             mlir::Value dest = resolveReference(arg->expression);
             b.create<P4HIR::AssignOp>(
-                getEndLoc(builder, mce),
-                builder.create<P4HIR::ReadOp>(getEndLoc(builder, mce), copyOut), dest);
+                getEndLoc(mce),
+                builder.create<P4HIR::ReadOp>(getEndLoc(mce), copyOut), dest);
         }
 
         // If we are inside the scope, then build the yield of the call result
         if (emitScope) {
             if (callResult) {
                 resultType = callResult.getType();
-                b.create<P4HIR::YieldOp>(getEndLoc(b, mce), callResult);
+                b.create<P4HIR::YieldOp>(getEndLoc(mce), callResult);
             } else
-                b.create<P4HIR::YieldOp>(getEndLoc(b, mce));
+                b.create<P4HIR::YieldOp>(getEndLoc(mce));
         } else {
             setValue(mce, callResult);
         }
     };
 
     if (emitScope) {
-        auto scope = builder.create<P4HIR::ScopeOp>(getLoc(builder, mce), convertCall);
+        auto scope = builder.create<P4HIR::ScopeOp>(
+            getLoc(mce),
+            [&](mlir::OpBuilder &b, mlir::Type &resultType, mlir::Location loc) {
+                ConversionScope valueScope(*this);
+                convertCall(b, resultType, loc);
+            });
         setValue(mce, scope.getResults());
     } else {
         mlir::Type resultType;
-        convertCall(builder, resultType, getLoc(builder, mce));
+        convertCall(builder, resultType, getLoc(mce));
     }
 
     return false;
@@ -1009,28 +1680,38 @@ bool P4HIRConverter::preorder(const P4::IR::MethodCallExpression *mce) {
 namespace P4::P4MLIR {
 
 mlir::OwningOpRef<mlir::ModuleOp> toMLIR(mlir::MLIRContext &context,
-                                         const P4::IR::P4Program *program, P4::TypeMap *typeMap) {
+                                         const P4::IR::P4Program *program, P4::TypeMap *typeMap,
+                                         const ConversionOptions &options,
+                                         ConversionStats *stats) {
     mlir::OpBuilder builder(&context);
 
     auto moduleOp = mlir::ModuleOp::create(builder.getUnknownLoc());
     builder.setInsertionPointToEnd(moduleOp.getBody());
 
-    if (auto sourceInfo = program->getSourceInfo(); sourceInfo.isValid()) {
-        moduleOp.setSymName(sourceInfo.getSourceFile().string_view());
-        moduleOp->setLoc(getLoc(builder, program));
+    {
+        llvm::TimeTraceScope traceScope("Convert to P4HIR");
+        P4HIRConverter conv(builder, typeMap, options.locations);
+        if (auto sourceInfo = program->getSourceInfo(); sourceInfo.isValid()) {
+            moduleOp.setSymName(sourceInfo.getSourceFile().string_view());
+            moduleOp->setLoc(conv.getLoc(program));
+        }
+        // Bodies are converted serially when conversion is logged or time
+        // traced, so the log stays readable and the trace, which is recorded
+        // per thread, is complete. Streamed functions are complete when
+        // visited, so they are never deferred either.
+        conv.setDeferBodies(options.parallelBodies && context.isMultithreadingEnabled() &&
+                            !LOGGING(4) && !llvm::timeTraceProfilerEnabled() &&
+                            !options.streamOp);
+        conv.setRoots(options.roots);
+        conv.setHoistConstants(options.hoistConstants);
+        conv.setStreamOp(options.streamOp);
+        program->apply(conv);
+        if (stats) *stats = conv.getStats();
+        if (conv.hasStreamFailed()) return nullptr;
     }
-    P4HIRConverter conv(builder, typeMap);
-    program->apply(conv);
 
     if (!program || P4::errorCount() > 0) return nullptr;
 
-    if (failed(mlir::verify(moduleOp))) {
-        // Dump for debugging purposes
-        moduleOp->print(llvm::outs());
-        moduleOp.emitError("module verification error");
-        return nullptr;
-    }
-
     return moduleOp;
 }
 
@@ -1,3 +1,8 @@
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 #include "mlir/IR/BuiltinOps.h"
@@ -12,6 +17,50 @@ class TypeMap;
 }  // namespace P4
 
 namespace P4::P4MLIR {
+// How source positions of P4 nodes are represented as MLIR locations
+enum class LocationMode {
+    // File, line and column of the node start
+    Full,
+    // File and line of the node start only, so nodes on the same line share
+    // the location
+    Line,
+    // Start and end of the node fused together
+    Range,
+};
+
+struct ConversionOptions {
+    // Names of top-level declarations to start conversion from. If given,
+    // only these declarations and everything they reference are converted.
+    std::vector<std::string> roots;
+    LocationMode locations = LocationMode::Full;
+    // Materialize each distinct constant once per function or action at the
+    // start of its entry block rather than at every use
+    bool hoistConstants = false;
+    // Convert function and action bodies in parallel using the thread pool of
+    // the context. Bodies are still converted serially when multithreading is
+    // disabled in the context or conversion is logged, time traced or streamed.
+    bool parallelBodies = false;
+    // When set, each top-level operation is passed to it as soon as it is
+    // completely converted, in module order. Function and action bodies are
+    // dropped afterwards, so only their declarations stay in the module. Bodies
+    // are always converted serially in this mode.
+    std::function<mlir::LogicalResult(mlir::Operation *)> streamOp;
+};
+
+// Number of entries added to the converter tables, i.e. the number of
+// converted values, constants, types and symbols
+struct ConversionStats {
+    size_t values = 0;
+    size_t constants = 0;
+    size_t types = 0;
+    size_t symbols = 0;
+};
+
+// Converts the program to P4HIR. If 'stats' is given, it is filled with
+// conversion statistics. The module is not verified, so the caller could
+// release the P4 program before that.
 mlir::OwningOpRef<mlir::ModuleOp> toMLIR(mlir::MLIRContext &context,
-                                         const P4::IR::P4Program *program, P4::TypeMap *typeMap);
+                                         const P4::IR::P4Program *program, P4::TypeMap *typeMap,
+                                         const ConversionOptions &options = {},
+                                         ConversionStats *stats = nullptr);
 }  // namespace P4::P4MLIR